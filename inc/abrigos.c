@@ -0,0 +1,98 @@
+#include <stdlib.h>
+#include <string.h>
+#include "abrigos.h"
+
+void abrigos_init(abrigos_t *abrigos, uint16_t quantidade) {
+  memset(abrigos, 0, sizeof(*abrigos));
+  abrigos->quantidade = quantidade > ABRIGOS_MAX ? ABRIGOS_MAX : quantidade;
+  for (uint16_t i = 0; i < abrigos->quantidade; i++) {
+    abrigos->qualidade_ar[i] = 50;
+    abrigos->morcegos[i] = 50;
+  }
+}
+
+// Leitura recebida de um abrigo (local ou remoto)
+void abrigos_registrar(abrigos_t *abrigos, uint16_t indice, int temperatura, int qualidade_ar, int morcegos) {
+  if (indice >= abrigos->quantidade)
+    return;
+  abrigos->temperatura[indice] = temperatura;
+  abrigos->qualidade_ar[indice] = qualidade_ar;
+  abrigos->morcegos[indice] = morcegos;
+}
+
+// Avalia todos os abrigos em passagens separadas sobre os vetores
+void abrigos_avaliar(abrigos_t *abrigos, uint32_t agora_ms) {
+  uint16_t n = abrigos->quantidade;
+  uint16_t em_alerta = 0;
+  uint16_t contaminados = 0;
+  uint16_t afetados = 0;
+
+  // Alerta de população: dispara quando a contagem muda para acima do limiar
+  for (uint16_t i = 0; i < n; i++) {
+    uint16_t morcegos = abrigos->morcegos[i];
+    bool perigo = morcegos > ABRIGO_LIMIAR_MORCEGOS;
+    if (morcegos != abrigos->morcegos_detectados[i]) {
+      abrigos->morcegos_detectados[i] = morcegos;
+      if (!perigo) {
+        abrigos->alerta[i] = false;
+      } else if (!abrigos->alerta[i]) {
+        abrigos->alerta[i] = true;
+        abrigos->alerta_inicio_ms[i] = agora_ms;
+      }
+    }
+    if (abrigos->alerta[i] && agora_ms - abrigos->alerta_inicio_ms[i] >= ABRIGO_ALERTA_DURACAO_MS)
+      abrigos->alerta[i] = false;
+    em_alerta += abrigos->alerta[i];
+  }
+
+  // Contaminação e risco
+  for (uint16_t i = 0; i < n; i++) {
+    int temperatura = abrigos->temperatura[i];
+    int qualidade_ar = abrigos->qualidade_ar[i];
+    int morcegos = abrigos->morcegos[i];
+    uint8_t contaminacao = (temperatura > ABRIGO_LIMIAR_TEMPERATURA) &
+                           (qualidade_ar < ABRIGO_LIMIAR_QUALIDADE_AR) &
+                           (morcegos > ABRIGO_LIMIAR_MORCEGOS);
+    abrigos->contaminacao[i] = contaminacao;
+    contaminados += contaminacao;
+    afetados += contaminacao | abrigos->alerta[i];  // Contaminação quase sempre vem com alerta
+
+    // Contaminação domina; depois calor, ar ruim e população
+    int risco = (contaminacao << 10) + (temperatura > 30 ? (temperatura - 30) * 8 : 0) +
+                (100 - qualidade_ar) * 2 + (morcegos >> 1);
+    abrigos->risco[i] = risco;
+  }
+
+  abrigos->em_alerta = em_alerta;
+  abrigos->contaminados = contaminados;
+  abrigos->afetados = afetados;
+}
+
+// Seleciona os k abrigos de maior risco (ordem decrescente) sem ordenar a tabela inteira
+uint16_t abrigos_piores(const abrigos_t *abrigos, uint16_t *indices, uint16_t k) {
+  uint16_t encontrados = 0;
+  if (k == 0)
+    return 0;
+  for (uint16_t i = 0; i < abrigos->quantidade; i++) {
+    uint16_t risco = abrigos->risco[i];
+    if (encontrados == k && risco <= abrigos->risco[indices[k - 1]])
+      continue;
+
+    uint16_t pos = encontrados < k ? encontrados++ : k - 1;
+    while (pos > 0 && abrigos->risco[indices[pos - 1]] < risco) {
+      indices[pos] = indices[pos - 1];
+      pos--;
+    }
+    indices[pos] = i;
+  }
+  return encontrados;
+}
+
+// Gera leituras aleatórias para os abrigos a partir de 'primeiro' (sem enlace com abrigos remotos)
+void abrigos_simular(abrigos_t *abrigos, uint16_t primeiro) {
+  for (uint16_t i = primeiro; i < abrigos->quantidade; i++) {
+    abrigos->temperatura[i] = 25 + rand() % 21;
+    abrigos->qualidade_ar[i] = rand() % 101;
+    abrigos->morcegos[i] = 10 + rand() % 171;
+  }
+}
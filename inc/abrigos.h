@@ -0,0 +1,47 @@
+#ifndef ABRIGOS_H
+#define ABRIGOS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Estado de vários abrigos (bat houses) em estrutura de vetores: cada grandeza fica em um
+// vetor contíguo e a avaliação de alertas percorre todos os abrigos de uma vez por ciclo.
+// O abrigo ABRIGO_LOCAL é o monitorado pelos sensores desta placa.
+
+#ifndef ABRIGOS_MAX
+#define ABRIGOS_MAX 32
+#endif
+#define ABRIGO_LOCAL 0
+
+// Limiares de alerta
+#define ABRIGO_LIMIAR_TEMPERATURA 40   // Contaminação acima desta temperatura...
+#define ABRIGO_LIMIAR_QUALIDADE_AR 70  // ...com qualidade do ar abaixo desta...
+#define ABRIGO_LIMIAR_MORCEGOS 50      // ...e mais morcegos do que isto
+#define ABRIGO_ALERTA_DURACAO_MS 5000  // Duração do alerta de população
+
+typedef struct {
+  uint16_t quantidade;
+  uint16_t em_alerta;         // Resumo da última avaliação
+  uint16_t contaminados;
+  uint16_t afetados;          // Em alerta ou contaminados, cada abrigo contado uma vez
+
+  int8_t temperatura[ABRIGOS_MAX];
+  uint8_t qualidade_ar[ABRIGOS_MAX];
+  uint16_t morcegos[ABRIGOS_MAX];
+  uint16_t morcegos_detectados[ABRIGOS_MAX];
+  uint32_t alerta_inicio_ms[ABRIGOS_MAX];
+  uint8_t alerta[ABRIGOS_MAX];        // População acima do limiar (dura ABRIGO_ALERTA_DURACAO_MS)
+  uint8_t contaminacao[ABRIGOS_MAX];  // Todas as condições de contaminação presentes
+  uint16_t risco[ABRIGOS_MAX];        // Usado para ordenar os piores abrigos
+} abrigos_t;
+
+// Bytes ocupados por abrigo nos vetores
+#define ABRIGO_BYTES (sizeof(int8_t) + sizeof(uint8_t) + 3 * sizeof(uint16_t) + sizeof(uint32_t) + 2 * sizeof(uint8_t))
+
+void abrigos_init(abrigos_t *abrigos, uint16_t quantidade);
+void abrigos_registrar(abrigos_t *abrigos, uint16_t indice, int temperatura, int qualidade_ar, int morcegos);
+void abrigos_avaliar(abrigos_t *abrigos, uint32_t agora_ms);
+uint16_t abrigos_piores(const abrigos_t *abrigos, uint16_t *indices, uint16_t k);
+void abrigos_simular(abrigos_t *abrigos, uint16_t primeiro);
+
+#endif // ABRIGOS_H
@@ -0,0 +1,154 @@
+#include "aht20.h"
+#include "i2c_fila.h"
+#include "crc8.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#define AHT20_CMD_INIT 0xBE
+#define AHT20_CMD_MEDIR 0xAC
+#define AHT20_STATUS_OCUPADO 0x80
+#define AHT20_STATUS_CALIBRADO 0x08
+#define AHT20_ESPERA_INIT_MS 10
+#define AHT20_ESPERA_CONVERSAO_MS 80
+#define AHT20_ESPERA_REPETIR_MS 10
+
+typedef enum {
+  AHT20_OCIOSO,
+  AHT20_INICIALIZANDO,
+  AHT20_CONVERTENDO,
+} aht20_estado_t;
+
+static struct {
+  volatile aht20_estado_t estado;
+  volatile bool presente;
+  volatile bool calibrado;
+  volatile int16_t temperatura_centi;  // 0,01 °C
+  volatile uint16_t umidade_centi;     // 0,01 %UR
+  volatile uint64_t primeira_leitura_us;
+  uint8_t leitura[7];                  // Status, 5 bytes de dados, CRC
+  repeating_timer_t timer;
+} aht20;
+
+static void aht20_ler(void);
+
+static void aht20_falha(void) {
+  aht20.presente = false;
+  aht20.calibrado = false;
+  aht20.estado = AHT20_OCIOSO;
+}
+
+static int64_t aht20_alarme_leitura(alarm_id_t id, void *ctx) {
+  aht20_ler();
+  return 0;
+}
+
+static void aht20_leitura_concluida(bool ok, void *ctx) {
+  if (!ok) {
+    aht20_falha();
+    return;
+  }
+
+  const uint8_t *b = aht20.leitura;
+  if (b[0] & AHT20_STATUS_OCUPADO) {
+    // Conversão ainda em andamento: tenta novamente em breve
+    add_alarm_in_ms(AHT20_ESPERA_REPETIR_MS, aht20_alarme_leitura, NULL, true);
+    return;
+  }
+
+  if (crc8_sensor(b, 6) == b[6]) {
+    uint32_t umidade = ((uint32_t)b[1] << 12) | ((uint32_t)b[2] << 4) | (b[3] >> 4);
+    uint32_t temperatura = ((uint32_t)(b[3] & 0x0F) << 16) | ((uint32_t)b[4] << 8) | b[5];
+    // Valores brutos de 20 bits: UR = raw * 100 / 2^20 e T = raw * 200 / 2^20 - 50
+    aht20.umidade_centi = (umidade * 625U) >> 16;
+    aht20.temperatura_centi = (int16_t)((temperatura * 625U) >> 15) - 5000;
+    aht20.presente = true;
+    if (!aht20.primeira_leitura_us)
+      aht20.primeira_leitura_us = time_us_64();
+  }
+  aht20.estado = AHT20_OCIOSO;
+}
+
+static void aht20_ler(void) {
+  if (!i2c_fila_ler(AHT20_ADDR, aht20.leitura, sizeof(aht20.leitura), I2C_PRIORIDADE_ALTA,
+                    aht20_leitura_concluida, NULL))
+    aht20.estado = AHT20_OCIOSO;
+}
+
+static void aht20_medicao_disparada(bool ok, void *ctx) {
+  if (!ok) {
+    aht20_falha();
+    return;
+  }
+  add_alarm_in_ms(AHT20_ESPERA_CONVERSAO_MS, aht20_alarme_leitura, NULL, true);
+}
+
+static void aht20_medir(void) {
+  static const uint8_t medir[] = { AHT20_CMD_MEDIR, 0x33, 0x00 };
+  aht20.estado = AHT20_CONVERTENDO;
+  if (!i2c_fila_escrever(AHT20_ADDR, medir, sizeof(medir), I2C_PRIORIDADE_ALTA, aht20_medicao_disparada, NULL))
+    aht20.estado = AHT20_OCIOSO;
+}
+
+static int64_t aht20_alarme_medir(alarm_id_t id, void *ctx) {
+  aht20_medir();
+  return 0;
+}
+
+// Primeira medição logo após a inicialização, sem esperar o próximo período
+static void aht20_inicializado(bool ok, void *ctx) {
+  if (!ok) {
+    aht20_falha();
+    return;
+  }
+  aht20.calibrado = true;
+  add_alarm_in_ms(AHT20_ESPERA_INIT_MS, aht20_alarme_medir, NULL, true);
+}
+
+// Disparado periodicamente pelo timer: inicializa o sensor ou começa uma nova conversão
+static bool aht20_periodo(repeating_timer_t *timer) {
+  if (aht20.estado != AHT20_OCIOSO)
+    return true;
+
+  if (!aht20.calibrado) {
+    static const uint8_t init[] = { AHT20_CMD_INIT, 0x08, 0x00 };
+    aht20.estado = AHT20_INICIALIZANDO;
+    if (!i2c_fila_escrever(AHT20_ADDR, init, sizeof(init), I2C_PRIORIDADE_ALTA, aht20_inicializado, NULL))
+      aht20.estado = AHT20_OCIOSO;
+    return true;
+  }
+
+  aht20_medir();
+  return true;
+}
+
+// Requer a fila I2C já inicializada. A inicialização é enviada já, e a primeira medição
+// logo depois dela; o timer só cuida das seguintes.
+void aht20_iniciar(uint32_t periodo_ms) {
+  aht20.estado = AHT20_OCIOSO;
+  aht20.presente = false;
+  aht20.calibrado = false;
+  aht20.primeira_leitura_us = 0;
+  add_repeating_timer_ms(periodo_ms, aht20_periodo, NULL, &aht20.timer);
+  aht20_periodo(&aht20.timer);
+}
+
+bool aht20_presente(void) {
+  return aht20.presente;
+}
+
+// Escrito na interrupção I2C: leitura de 64 bits com as interrupções mascaradas
+uint64_t aht20_primeira_leitura(void) {
+  uint32_t estado = save_and_disable_interrupts();
+  uint64_t instante = aht20.primeira_leitura_us;
+  restore_interrupts(estado);
+  return instante;
+}
+
+int aht20_temperatura(void) {
+  int centi = aht20.temperatura_centi;
+  return (centi + (centi >= 0 ? 50 : -50)) / 100;
+}
+
+int aht20_umidade(void) {
+  return (aht20.umidade_centi + 50) / 100;
+}
@@ -0,0 +1,19 @@
+#ifndef AHT20_H
+#define AHT20_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Sensor de temperatura e umidade AHT20, lido pela fila I2C sem bloquear.
+// A conversão (80 ms) é aguardada com alarmes do timer.
+
+#define AHT20_ADDR 0x38
+#define AHT20_PERIODO_MS 2000  // Intervalo entre medições
+
+void aht20_iniciar(uint32_t periodo_ms);
+bool aht20_presente(void);           // Verdadeiro após a primeira leitura válida
+uint64_t aht20_primeira_leitura(void);  // Instante da primeira leitura válida (0 = nenhuma)
+int aht20_temperatura(void);         // Graus Celsius
+int aht20_umidade(void);             // Porcentagem de umidade relativa
+
+#endif // AHT20_H
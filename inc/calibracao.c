@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "calibracao.h"
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+
+#define CALIB_MAGICA 0x43414C31u  // "CAL1"
+// Último setor da flash, longe do programa
+#define CALIB_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+
+typedef struct {
+  uint32_t magica;
+  uint16_t centro[CALIB_CANAIS];
+  uint16_t zona_morta[CALIB_CANAIS];
+  uint32_t soma;
+} calibracao_dados_t;
+
+int8_t calibracao_tabela[CALIB_CANAIS][CALIB_TABELA_TAM];
+
+static calibracao_dados_t dados;
+static volatile bool pendente = false;
+static bool solto = false;       // Botão já visto solto desde o pedido
+static uint32_t solto_desde_ms;
+
+static uint32_t calibracao_soma(const calibracao_dados_t *d) {
+  uint32_t soma = d->magica;
+  for (uint c = 0; c < CALIB_CANAIS; c++)
+    soma = soma * 31u + ((uint32_t)d->centro[c] << 16 | d->zona_morta[c]);
+  return soma;
+}
+
+// Cada entrada usa o ponto médio da faixa de leituras que ela cobre
+static void calibracao_montar_tabela(uint canal) {
+  int32_t centro = dados.centro[canal];
+  int32_t zona_morta = dados.zona_morta[canal];
+  int32_t abaixo = centro;          // Faixa útil abaixo do centro
+  int32_t acima = 4095 - centro;    // Faixa útil acima do centro
+
+  for (uint i = 0; i < CALIB_TABELA_TAM; i++) {
+    int32_t adc = (i << CALIB_TABELA_SHIFT) + (1 << (CALIB_TABELA_SHIFT - 1));
+    int32_t deslocamento = adc - centro;
+    int32_t percentual = 0;
+    if (deslocamento > zona_morta)
+      percentual = (deslocamento * 100) / acima;
+    else if (deslocamento < -zona_morta)
+      percentual = (deslocamento * 100) / abaixo;
+    if (percentual > 100) percentual = 100;
+    if (percentual < -100) percentual = -100;
+    calibracao_tabela[canal][i] = (int8_t)percentual;
+  }
+}
+
+static bool calibracao_carregar(void) {
+  const calibracao_dados_t *flash = (const calibracao_dados_t *)(XIP_BASE + CALIB_FLASH_OFFSET);
+  if (flash->magica != CALIB_MAGICA || flash->soma != calibracao_soma(flash))
+    return false;
+  dados = *flash;
+  return true;
+}
+
+static void calibracao_gravar(void) {
+  uint8_t pagina[FLASH_PAGE_SIZE];
+  memset(pagina, 0xFF, sizeof(pagina));
+  memcpy(pagina, &dados, sizeof(dados));
+
+  // Nenhum código pode rodar da flash durante a gravação
+  uint32_t estado = save_and_disable_interrupts();
+  flash_range_erase(CALIB_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+  flash_range_program(CALIB_FLASH_OFFSET, pagina, FLASH_PAGE_SIZE);
+  restore_interrupts(estado);
+}
+
+void calibracao_init(void) {
+  if (!calibracao_carregar() && !calibracao_medir()) {
+    // Sem calibração válida: centro nominal do ADC
+    for (uint c = 0; c < CALIB_CANAIS; c++) {
+      dados.centro[c] = 2048;
+      dados.zona_morta[c] = CALIB_ZONA_MORTA_MIN;
+    }
+  }
+  for (uint c = 0; c < CALIB_CANAIS; c++)
+    calibracao_montar_tabela(c);
+}
+
+bool calibracao_medir(void) {
+  calibracao_dados_t novo = { .magica = CALIB_MAGICA };
+
+  for (uint c = 0; c < CALIB_CANAIS; c++) {
+    uint32_t soma = 0;
+    uint16_t minimo = 4095, maximo = 0;
+    adc_select_input(c);
+    for (uint i = 0; i < CALIB_AMOSTRAS; i++) {
+      uint16_t adc = adc_read();
+      soma += adc;
+      if (adc < minimo) minimo = adc;
+      if (adc > maximo) maximo = adc;
+      sleep_us(200);
+    }
+
+    uint16_t ruido = maximo - minimo;
+    if (ruido > CALIB_RUIDO_MAX) {
+      printf("Calibracao rejeitada: canal %u em movimento (ruido %u)\n", c, ruido);
+      pendente = false;
+      return false;
+    }
+    uint16_t centro = soma / CALIB_AMOSTRAS;
+    if (abs((int)centro - 2048) > CALIB_CENTRO_DESVIO_MAX) {
+      printf("Calibracao rejeitada: canal %u desviado (centro %u)\n", c, centro);
+      pendente = false;
+      return false;
+    }
+    novo.centro[c] = centro;
+    novo.zona_morta[c] = MAX(CALIB_ZONA_MORTA_MIN, 2 * ruido);
+  }
+
+  novo.soma = calibracao_soma(&novo);
+  dados = novo;
+  for (uint c = 0; c < CALIB_CANAIS; c++) {
+    calibracao_montar_tabela(c);
+    printf("Calibracao canal %u: centro %u, zona morta %u\n", c, dados.centro[c], dados.zona_morta[c]);
+  }
+  calibracao_gravar();
+  pendente = false;
+  return true;
+}
+
+void calibracao_solicitar(void) {
+  pendente = true;
+}
+
+bool calibracao_pendente(void) {
+  return pendente;
+}
+
+bool calibracao_atualizar(bool botao_pressionado, uint32_t agora_ms) {
+  if (!pendente)
+    return false;
+  if (botao_pressionado) {
+    solto = false;  // Pressionado de novo durante a espera: recomeça
+    return false;
+  }
+  if (!solto) {
+    solto = true;
+    solto_desde_ms = agora_ms;
+  }
+  if (agora_ms - solto_desde_ms < CALIB_ASSENTAMENTO_MS)
+    return false;
+  solto = false;
+  return calibracao_medir();
+}
+
+uint16_t calibracao_centro(uint canal) {
+  return dados.centro[canal];
+}
+
+void calibracao_barra_init(calibracao_barra_t *barra, int16_t minimo, int16_t maximo, uint8_t largura_max) {
+  barra->minimo = minimo;
+  barra->largura_max = largura_max;
+  uint32_t faixa = maximo - minimo;
+  barra->escala_q16 = (((uint32_t)largura_max << 16) + faixa - 1) / faixa;  // Arredonda para cima
+}
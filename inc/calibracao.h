@@ -0,0 +1,57 @@
+#ifndef CALIBRACAO_H
+#define CALIBRACAO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+
+// Calibração dos canais do ADC (joystick). O centro e o ruído de cada canal são medidos
+// com o joystick em repouso e gravados na flash; a partir deles são montadas tabelas que
+// convertem a leitura bruta em deslocamento percentual (-100 a 100, zona morta já aplicada).
+// No laço principal a conversão é apenas uma consulta à tabela. Os extremos não são medidos:
+// a faixa vai do centro até 0 e 4095 (o firmware só usa o sentido do deslocamento).
+
+#define CALIB_CANAIS 2
+#define CALIB_AMOSTRAS 64
+#define CALIB_TABELA_SHIFT 4                          // Tabela indexada pelos 8 bits altos do ADC
+#define CALIB_TABELA_TAM (4096 >> CALIB_TABELA_SHIFT)
+#define CALIB_ZONA_MORTA_MIN 40                       // Zona morta mínima (contagens do ADC)
+#define CALIB_RUIDO_MAX 200                           // Acima disso o joystick não estava em repouso
+#define CALIB_CENTRO_DESVIO_MAX 512                   // Centro mais longe que isso do meio da escala: manche desviado
+#define CALIB_ASSENTAMENTO_MS 500                     // Botão solto há este tempo antes de medir
+
+extern int8_t calibracao_tabela[CALIB_CANAIS][CALIB_TABELA_TAM];
+
+void calibracao_init(void);       // Carrega da flash ou mede e grava
+bool calibracao_medir(void);      // Mede, reconstrói as tabelas e grava; falso se rejeitada
+void calibracao_solicitar(void);  // Seguro em interrupções: pede nova calibração
+bool calibracao_pendente(void);
+// Chamada no laço: atende o pedido só depois de o botão ficar solto por CALIB_ASSENTAMENTO_MS,
+// para o dedo ainda no manche não ser medido como centro. Verdadeiro se mediu e gravou.
+bool calibracao_atualizar(bool botao_pressionado, uint32_t agora_ms);
+uint16_t calibracao_centro(uint canal);
+
+// Leitura bruta do ADC -> deslocamento percentual do canal
+static inline int8_t calibracao_deslocamento(uint canal, uint16_t adc) {
+  return calibracao_tabela[canal][adc >> CALIB_TABELA_SHIFT];
+}
+
+// Mapeamento de grandeza física -> largura de barra em pixels por multiplicação pelo
+// recíproco em ponto fixo Q16, calculado uma única vez
+typedef struct {
+  int16_t minimo;
+  uint8_t largura_max;
+  uint32_t escala_q16;
+} calibracao_barra_t;
+
+void calibracao_barra_init(calibracao_barra_t *barra, int16_t minimo, int16_t maximo, uint8_t largura_max);
+
+static inline uint8_t calibracao_barra(const calibracao_barra_t *barra, int valor) {
+  int32_t deslocamento = valor - barra->minimo;
+  if (deslocamento <= 0)
+    return 0;
+  uint32_t largura = ((uint32_t)deslocamento * barra->escala_q16) >> 16;
+  return largura > barra->largura_max ? barra->largura_max : (uint8_t)largura;
+}
+
+#endif // CALIBRACAO_H
@@ -0,0 +1,19 @@
+#ifndef CRC8_H
+#define CRC8_H
+
+#include <stdint.h>
+
+// CRC-8 usado pelos sensores da Sensirion/Aosong (SGP30, AHT20): polinômio 0x31
+// (x^8 + x^5 + x^4 + 1), valor inicial 0xFF, sem reflexão nem XOR final.
+// Exemplo da folha de dados do SGP30: crc8_sensor({ 0xBE, 0xEF }, 2) == 0x92.
+static inline uint8_t crc8_sensor(const uint8_t *dados, uint8_t len) {
+  uint8_t crc = 0xFF;
+  for (uint8_t i = 0; i < len; i++) {
+    crc ^= dados[i];
+    for (uint8_t b = 0; b < 8; b++)
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : crc << 1;
+  }
+  return crc;
+}
+
+#endif // CRC8_H
@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <string.h>
+#include "energia.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+static struct {
+  ssd1306_t *ssd;
+  uint32_t periodo_us;
+  uint32_t ocioso_us;
+  uint64_t proxima_amostra;
+
+  volatile bool acordar;
+  volatile uint64_t ultima_atividade;
+  volatile uint64_t instante_evento;  // Quando o último evento pediu para acordar (0 = nenhum)
+  bool display_ligado;
+
+  // Contabilidade de tempo (us)
+  uint64_t inicio;
+  uint64_t dormindo;
+  uint64_t display;
+  uint64_t display_desde;
+  uint32_t despertares;
+  uint32_t interrupcoes_no_sono;
+  uint32_t latencia_max;
+  uint64_t ultimo_relatorio;
+} energia;
+
+static int64_t energia_alarme(alarm_id_t id, void *ctx) {
+  energia.acordar = true;
+  return 0;
+}
+
+// Estado só muda se o comando entrou na fila; senão a próxima chamada tenta de novo
+static void energia_display(bool ligar) {
+  if (energia.display_ligado == ligar)
+    return;
+  if (!ssd1306_command(energia.ssd, SET_DISP | (ligar ? 0x01 : 0x00)))
+    return;
+  uint64_t agora = time_us_64();
+  if (ligar)
+    energia.display_desde = agora;
+  else
+    energia.display += agora - energia.display_desde;
+  energia.display_ligado = ligar;
+}
+
+void energia_init(ssd1306_t *ssd, uint32_t periodo_ms, uint32_t ocioso_ms) {
+  memset(&energia, 0, sizeof(energia));
+  energia.ssd = ssd;
+  energia.periodo_us = periodo_ms * 1000U;
+  energia.ocioso_us = ocioso_ms * 1000U;
+
+  uint64_t agora = time_us_64();
+  energia.inicio = agora;
+  energia.ultimo_relatorio = agora;
+  energia.proxima_amostra = agora + energia.periodo_us;
+  energia.ultima_atividade = agora;
+  energia.display_desde = agora;
+  energia.display_ligado = true;  // ssd1306_config deixa o display ligado
+}
+
+void energia_evento(void) {
+  uint64_t agora = time_us_64();
+  energia.ultima_atividade = agora;
+  energia.instante_evento = agora;
+  energia.acordar = true;
+}
+
+void energia_manter_ativo(void) {
+  uint32_t estado = save_and_disable_interrupts();
+  energia.ultima_atividade = time_us_64();
+  restore_interrupts(estado);
+  energia_display(true);
+}
+
+bool energia_display_ligado(void) {
+  return energia.display_ligado;
+}
+
+void energia_dormir(void) {
+  uint64_t agora = time_us_64();
+
+  // Valores de 64 bits escritos pela interrupção de GPIO: no M0+ a leitura leva duas
+  // instruções e precisa das interrupções mascaradas para não ler metades de escritas diferentes
+  uint32_t estado = save_and_disable_interrupts();
+  uint64_t ultima_atividade = energia.ultima_atividade;
+  restore_interrupts(estado);
+
+  // Desliga por ociosidade, ou repete um liga/desliga que não coube na fila I2C
+  energia_display(agora - ultima_atividade < energia.ocioso_us);
+
+  if (energia.proxima_amostra > agora && !energia.acordar) {
+    alarm_id_t alarme = add_alarm_at(from_us_since_boot(energia.proxima_amostra), energia_alarme, NULL, true);
+
+    // Interrupções mascaradas entre o teste e o WFI: um evento pendente ainda acorda o núcleo
+    while (true) {
+      uint32_t estado = save_and_disable_interrupts();
+      if (energia.acordar) {
+        restore_interrupts(estado);
+        break;
+      }
+      __wfi();
+      restore_interrupts(estado);
+
+      // Outra interrupção tirou o núcleo do WFI: volta a dormir, mas o despertar fica contado
+      // (o tempo dela entra como sono)
+      if (!energia.acordar)
+        energia.interrupcoes_no_sono++;
+    }
+
+    if (alarme > 0)
+      cancel_alarm(alarme);
+  }
+
+  uint64_t acordou = time_us_64();
+  energia.dormindo += acordou - agora;
+  energia.despertares++;
+
+  estado = save_and_disable_interrupts();
+  uint64_t instante_evento = energia.instante_evento;
+  energia.instante_evento = 0;
+  energia.acordar = false;
+  restore_interrupts(estado);
+
+  if (instante_evento) {
+    uint32_t latencia = acordou - instante_evento;
+    if (latencia > energia.latencia_max)
+      energia.latencia_max = latencia;
+    energia_display(true);
+  }
+
+  // Agenda a próxima amostra sem acumular atraso caso o processamento tenha passado do período
+  if (energia.proxima_amostra <= acordou) {
+    energia.proxima_amostra += energia.periodo_us;
+    if (energia.proxima_amostra <= acordou)
+      energia.proxima_amostra = acordou + energia.periodo_us;
+  }
+}
+
+void energia_estatisticas(energia_estatisticas_t *estatisticas) {
+  uint64_t agora = time_us_64();
+  estatisticas->total_us = agora - energia.inicio;
+  estatisticas->dormindo_us = energia.dormindo;
+  estatisticas->acordado_us = estatisticas->total_us - energia.dormindo;
+  estatisticas->display_us = energia.display + (energia.display_ligado ? agora - energia.display_desde : 0);
+  estatisticas->despertares = energia.despertares;
+  estatisticas->interrupcoes_no_sono = energia.interrupcoes_no_sono;
+  estatisticas->latencia_max_us = energia.latencia_max;
+  estatisticas->proxima_amostra_us = energia.proxima_amostra;
+}
+
+void energia_relatar_periodicamente(void) {
+  uint64_t agora = time_us_64();
+  if (agora - energia.ultimo_relatorio < ENERGIA_RELATORIO_MS * 1000ULL)
+    return;
+  energia.ultimo_relatorio = agora;
+
+  energia_estatisticas_t e;
+  energia_estatisticas(&e);
+
+  // Carga em mAh: corrente (mA) x tempo (us) / 3,6e9
+  float carga = (ENERGIA_CORRENTE_ATIVO_MA * e.acordado_us + ENERGIA_CORRENTE_SONO_MA * e.dormindo_us +
+                 ENERGIA_CORRENTE_DISPLAY_MA * e.display_us) / 3.6e9f;
+  float horas = e.total_us / 3.6e9f;
+
+  printf("Energia: acordado %.1f%%, display %.1f%%, %lu despertares (+%lu interrupcoes no sono), "
+         "latencia max %lu us, %.2f mAh (media %.1f mA)\n",
+         100.0f * e.acordado_us / e.total_us, 100.0f * e.display_us / e.total_us,
+         (unsigned long)e.despertares, (unsigned long)e.interrupcoes_no_sono,
+         (unsigned long)e.latencia_max_us, carga, carga / horas);
+}
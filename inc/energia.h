@@ -0,0 +1,39 @@
+#ifndef ENERGIA_H
+#define ENERGIA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ssd1306.h"
+
+// Gerenciador de energia: o núcleo dorme (WFI) entre amostras agendadas e acorda pelo
+// alarme da próxima amostra ou por eventos de GPIO. O display é desligado após um
+// período sem atividade e religado no próximo evento.
+
+#define ENERGIA_RELATORIO_MS 60000  // Intervalo entre relatórios de consumo
+
+// Correntes típicas usadas na estimativa de consumo (mA)
+#define ENERGIA_CORRENTE_ATIVO_MA 25.0f    // RP2040 executando a 125 MHz
+#define ENERGIA_CORRENTE_SONO_MA 8.0f      // RP2040 em WFI com clocks ativos
+#define ENERGIA_CORRENTE_DISPLAY_MA 12.0f  // SSD1306 ligado (metade dos pixels acesos)
+
+// Contabilidade desde energia_init, usada pelo relatório periódico
+typedef struct {
+  uint64_t total_us;
+  uint64_t acordado_us;
+  uint64_t dormindo_us;
+  uint64_t display_us;          // Tempo com o display ligado
+  uint32_t despertares;
+  uint32_t interrupcoes_no_sono;  // WFI interrompido sem encerrar o sono (timers de outros módulos)
+  uint32_t latencia_max_us;     // Maior atraso entre um evento e a volta do WFI
+  uint64_t proxima_amostra_us;  // Instante agendado para a próxima amostra
+} energia_estatisticas_t;
+
+void energia_init(ssd1306_t *ssd, uint32_t periodo_ms, uint32_t ocioso_ms);
+void energia_dormir(void);          // Dorme até a próxima amostra ou um evento
+void energia_evento(void);          // Seguro em interrupções: acorda o núcleo e marca atividade
+void energia_manter_ativo(void);    // Marca atividade e liga o display imediatamente
+bool energia_display_ligado(void);
+void energia_estatisticas(energia_estatisticas_t *estatisticas);
+void energia_relatar_periodicamente(void);
+
+#endif // ENERGIA_H
@@ -0,0 +1,253 @@
+#include <string.h>
+#include "i2c_fila.h"
+#include "pico/stdlib.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+#define INTR_TRANSACAO (I2C_IC_INTR_MASK_M_TX_ABRT_BITS | I2C_IC_INTR_MASK_M_STOP_DET_BITS | \
+                        I2C_IC_INTR_MASK_M_RX_FULL_BITS)
+
+// Profundidade das FIFOs de TX e RX do controlador I2C do RP2040 (o próprio SDK usa 16 em
+// i2c_get_write_available em vez de um nome dos cabeçalhos de registradores)
+#define I2C_FILA_FIFO 16
+
+// Acesso aos registradores do controlador. Nos testes no host (test/) o controlador é
+// simulado: I2C_FILA_CONTROLADOR_SIMULADO troca estas funções pelas do simulador.
+#ifdef I2C_FILA_CONTROLADOR_SIMULADO
+void i2c_hw_configurar(i2c_inst_t *i2c, uint32_t tx_limiar);
+void i2c_hw_alvo(i2c_inst_t *i2c, uint8_t endereco);
+uint32_t i2c_hw_tx_nivel(i2c_inst_t *i2c);
+uint32_t i2c_hw_rx_nivel(i2c_inst_t *i2c);
+void i2c_hw_comando(i2c_inst_t *i2c, uint32_t cmd);
+uint8_t i2c_hw_dado(i2c_inst_t *i2c);
+uint32_t i2c_hw_status(i2c_inst_t *i2c);
+void i2c_hw_limpar(i2c_inst_t *i2c, uint32_t status);
+void i2c_hw_mascara(i2c_inst_t *i2c, uint32_t mascara);
+#else
+static inline void i2c_hw_configurar(i2c_inst_t *i2c, uint32_t tx_limiar) {
+  i2c_hw_t *hw = i2c_get_hw(i2c);
+  hw->enable = 0;
+  hw->intr_mask = 0;
+  hw->rx_tl = 0;           // Interrompe a cada byte recebido
+  hw->tx_tl = tx_limiar;
+  hw->enable = 1;
+}
+
+static inline void i2c_hw_alvo(i2c_inst_t *i2c, uint8_t endereco) {
+  i2c_hw_t *hw = i2c_get_hw(i2c);
+  hw->enable = 0;
+  hw->tar = endereco;
+  hw->enable = 1;
+}
+
+static inline uint32_t i2c_hw_tx_nivel(i2c_inst_t *i2c) { return i2c_get_hw(i2c)->txflr; }
+static inline uint32_t i2c_hw_rx_nivel(i2c_inst_t *i2c) { return i2c_get_hw(i2c)->rxflr; }
+static inline void i2c_hw_comando(i2c_inst_t *i2c, uint32_t cmd) { i2c_get_hw(i2c)->data_cmd = cmd; }
+static inline uint8_t i2c_hw_dado(i2c_inst_t *i2c) { return (uint8_t)i2c_get_hw(i2c)->data_cmd; }
+static inline uint32_t i2c_hw_status(i2c_inst_t *i2c) { return i2c_get_hw(i2c)->intr_stat; }
+static inline void i2c_hw_mascara(i2c_inst_t *i2c, uint32_t mascara) { i2c_get_hw(i2c)->intr_mask = mascara; }
+
+// Interrupções de TX_ABRT e STOP_DET são limpas pela leitura dos registradores de limpeza
+static inline void i2c_hw_limpar(i2c_inst_t *i2c, uint32_t status) {
+  i2c_hw_t *hw = i2c_get_hw(i2c);
+  if (status & I2C_IC_INTR_STAT_R_TX_ABRT_BITS)
+    (void)hw->clr_tx_abrt;
+  if (status & I2C_IC_INTR_STAT_R_STOP_DET_BITS)
+    (void)hw->clr_stop_det;
+}
+#endif
+
+static struct {
+  i2c_inst_t *i2c;
+  i2c_transacao_t anel[I2C_PRIORIDADES][I2C_FILA_CAPACIDADE];
+  uint8_t inicio[I2C_PRIORIDADES];
+  uint8_t quantidade[I2C_PRIORIDADES];
+
+  // Transação em andamento
+  i2c_transacao_t atual;
+  volatile bool ocupado;
+  volatile uint64_t inicio_us;  // Início da transação em andamento
+  bool abortado;
+  uint16_t tx_pos;   // Bytes de escrita já colocados na FIFO
+  uint16_t rd_cmds;  // Comandos de leitura já colocados na FIFO
+  uint16_t rx_pos;   // Bytes já lidos
+
+  volatile uint32_t erros;
+} fila;
+
+static inline uint8_t byte_tx(const i2c_transacao_t *t, uint16_t pos) {
+  return pos < t->tx_curto_len ? t->tx_curto[pos] : t->tx[pos - t->tx_curto_len];
+}
+
+// Coloca comandos na FIFO de transmissão até enchê-la ou terminar a transação
+static void alimentar_fifo(void) {
+  const i2c_transacao_t *t = &fila.atual;
+  uint16_t total_tx = t->tx_curto_len + t->tx_len;
+  bool pendente = false;
+
+  while (i2c_hw_tx_nivel(fila.i2c) < I2C_FILA_FIFO) {
+    if (fila.tx_pos < total_tx) {
+      uint32_t cmd = byte_tx(t, fila.tx_pos++);
+      if (fila.tx_pos == total_tx && t->rx_len == 0)
+        cmd |= I2C_IC_DATA_CMD_STOP_BITS;
+      i2c_hw_comando(fila.i2c, cmd);
+    } else if (fila.rd_cmds < t->rx_len) {
+      // Não pede mais bytes do que cabem na FIFO de recepção
+      if (fila.rd_cmds - fila.rx_pos >= I2C_FILA_FIFO)
+        break;
+      uint32_t cmd = I2C_IC_DATA_CMD_CMD_BITS;
+      if (fila.rd_cmds == 0 && total_tx > 0)
+        cmd |= I2C_IC_DATA_CMD_RESTART_BITS;
+      if (++fila.rd_cmds == t->rx_len)
+        cmd |= I2C_IC_DATA_CMD_STOP_BITS;
+      i2c_hw_comando(fila.i2c, cmd);
+    } else {
+      break;
+    }
+  }
+
+  if (fila.tx_pos < total_tx)
+    pendente = true;
+  else if (fila.rd_cmds < t->rx_len && fila.rd_cmds - fila.rx_pos < I2C_FILA_FIFO)
+    pendente = true;
+
+  // TX_EMPTY só fica habilitado enquanto houver algo a escrever; leituras retomam via RX_FULL
+  i2c_hw_mascara(fila.i2c, INTR_TRANSACAO | (pendente ? I2C_IC_INTR_MASK_M_TX_EMPTY_BITS : 0));
+}
+
+// Deve ser chamada com interrupções desabilitadas ou a partir da própria interrupção
+static void iniciar_proxima(void) {
+  for (int p = 0; p < I2C_PRIORIDADES; p++) {
+    if (fila.quantidade[p] == 0)
+      continue;
+
+    fila.atual = fila.anel[p][fila.inicio[p]];
+    fila.inicio[p] = (fila.inicio[p] + 1) % I2C_FILA_CAPACIDADE;
+    fila.quantidade[p]--;
+
+    i2c_hw_alvo(fila.i2c, fila.atual.endereco);
+
+    fila.tx_pos = 0;
+    fila.rd_cmds = 0;
+    fila.rx_pos = 0;
+    fila.abortado = false;
+    fila.inicio_us = time_us_64();
+    fila.ocupado = true;
+    alimentar_fifo();
+    return;
+  }
+  fila.ocupado = false;
+}
+
+static void concluir(void) {
+  i2c_transacao_t t = fila.atual;
+  bool ok = !fila.abortado && fila.rx_pos == t.rx_len;
+  if (!ok)
+    fila.erros++;
+
+  i2c_hw_mascara(fila.i2c, 0);
+  iniciar_proxima();
+
+  if (t.callback)
+    t.callback(ok, t.ctx);
+}
+
+static void i2c_fila_irq(void) {
+  uint32_t stat = i2c_hw_status(fila.i2c);
+
+  if (stat & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+    i2c_hw_limpar(fila.i2c, I2C_IC_INTR_STAT_R_TX_ABRT_BITS);  // Libera a FIFO; o controlador gera STOP em seguida
+    fila.abortado = true;
+    i2c_hw_mascara(fila.i2c, INTR_TRANSACAO);  // FIFO vazia após o abort: sem TX_EMPTY até o STOP
+  }
+
+  while (i2c_hw_rx_nivel(fila.i2c) > 0) {
+    uint8_t byte = i2c_hw_dado(fila.i2c);
+    if (fila.rx_pos < fila.atual.rx_len)
+      fila.atual.rx[fila.rx_pos++] = byte;
+  }
+
+  if (stat & I2C_IC_INTR_STAT_R_STOP_DET_BITS) {
+    i2c_hw_limpar(fila.i2c, I2C_IC_INTR_STAT_R_STOP_DET_BITS);
+    concluir();
+    return;
+  }
+
+  if (fila.ocupado && !fila.abortado)
+    alimentar_fifo();
+}
+
+// Chamar após i2c_init(); a partir daqui o barramento pertence à fila
+void i2c_fila_init(i2c_inst_t *i2c) {
+  memset(&fila, 0, sizeof(fila));
+  fila.i2c = i2c;
+
+  i2c_hw_configurar(i2c, I2C_FILA_FIFO / 2);  // Realimenta com a FIFO pela metade
+
+  uint irq = I2C0_IRQ + i2c_hw_index(i2c);
+  irq_set_exclusive_handler(irq, i2c_fila_irq);
+  irq_set_enabled(irq, true);
+}
+
+// Copia a transação para a fila; pode ser chamada de interrupções e callbacks
+bool i2c_fila_enviar(const i2c_transacao_t *transacao, i2c_prioridade_t prioridade) {
+  if (transacao->tx_curto_len + transacao->tx_len == 0 && transacao->rx_len == 0)
+    return false;
+
+  uint32_t estado = save_and_disable_interrupts();
+  bool aceita = fila.quantidade[prioridade] < I2C_FILA_CAPACIDADE;
+  if (aceita) {
+    uint8_t pos = (fila.inicio[prioridade] + fila.quantidade[prioridade]) % I2C_FILA_CAPACIDADE;
+    fila.anel[prioridade][pos] = *transacao;
+    fila.quantidade[prioridade]++;
+    if (!fila.ocupado)
+      iniciar_proxima();
+  }
+  restore_interrupts(estado);
+  return aceita;
+}
+
+bool i2c_fila_escrever(uint8_t endereco, const uint8_t *dados, uint8_t len, i2c_prioridade_t prioridade,
+                       i2c_fila_callback_t callback, void *ctx) {
+  if (len > I2C_FILA_TX_CURTO)
+    return false;
+  i2c_transacao_t t = {
+    .endereco = endereco,
+    .tx_curto_len = len,
+    .callback = callback,
+    .ctx = ctx,
+  };
+  memcpy(t.tx_curto, dados, len);
+  return i2c_fila_enviar(&t, prioridade);
+}
+
+bool i2c_fila_ler(uint8_t endereco, uint8_t *rx, uint16_t rx_len, i2c_prioridade_t prioridade,
+                  i2c_fila_callback_t callback, void *ctx) {
+  i2c_transacao_t t = {
+    .endereco = endereco,
+    .rx = rx,
+    .rx_len = rx_len,
+    .callback = callback,
+    .ctx = ctx,
+  };
+  return i2c_fila_enviar(&t, prioridade);
+}
+
+uint32_t i2c_fila_livres(i2c_prioridade_t prioridade) {
+  return I2C_FILA_CAPACIDADE - fila.quantidade[prioridade];
+}
+
+bool i2c_fila_ociosa(void) {
+  return !fila.ocupado;
+}
+
+uint32_t i2c_fila_erros(void) {
+  return fila.erros;
+}
+
+bool i2c_fila_travada(uint32_t limite_us) {
+  uint32_t estado = save_and_disable_interrupts();
+  bool travada = fila.ocupado && time_us_64() - fila.inicio_us > limite_us;
+  restore_interrupts(estado);
+  return travada;
+}
@@ -0,0 +1,48 @@
+#ifndef I2C_FILA_H
+#define I2C_FILA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hardware/i2c.h"
+
+// Fila de transações I2C não bloqueante. As transações são executadas por interrupção,
+// uma por vez, sempre atendendo primeiro a prioridade mais alta. Transferências longas
+// (ex.: quadro do display) devem ser divididas em blocos para que leituras de sensores
+// possam ser intercaladas entre eles.
+
+#define I2C_FILA_CAPACIDADE 40  // Transações pendentes por prioridade
+#define I2C_FILA_TX_CURTO 8     // Bytes copiados para dentro da transação na inserção
+
+typedef enum {
+  I2C_PRIORIDADE_ALTA = 0,   // Sensores
+  I2C_PRIORIDADE_BAIXA,      // Display
+  I2C_PRIORIDADES
+} i2c_prioridade_t;
+
+// Chamada no contexto da interrupção ao final da transação (ok = false em caso de NACK/abort)
+typedef void (*i2c_fila_callback_t)(bool ok, void *ctx);
+
+typedef struct {
+  uint8_t endereco;
+  uint8_t tx_curto[I2C_FILA_TX_CURTO];  // Enviados primeiro (comandos, byte de controle)
+  uint8_t tx_curto_len;
+  const uint8_t *tx;                    // Dados externos enviados em seguida (devem permanecer válidos)
+  uint16_t tx_len;
+  uint8_t *rx;                          // Destino da leitura, feita após a escrita com RESTART
+  uint16_t rx_len;
+  i2c_fila_callback_t callback;
+  void *ctx;
+} i2c_transacao_t;
+
+void i2c_fila_init(i2c_inst_t *i2c);
+bool i2c_fila_enviar(const i2c_transacao_t *transacao, i2c_prioridade_t prioridade);
+bool i2c_fila_escrever(uint8_t endereco, const uint8_t *dados, uint8_t len, i2c_prioridade_t prioridade,
+                       i2c_fila_callback_t callback, void *ctx);
+bool i2c_fila_ler(uint8_t endereco, uint8_t *rx, uint16_t rx_len, i2c_prioridade_t prioridade,
+                  i2c_fila_callback_t callback, void *ctx);
+uint32_t i2c_fila_livres(i2c_prioridade_t prioridade);
+bool i2c_fila_ociosa(void);
+uint32_t i2c_fila_erros(void);
+bool i2c_fila_travada(uint32_t limite_us);  // Transação em andamento há mais de limite_us
+
+#endif // I2C_FILA_H
@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include "inicializacao.h"
+#include "pico/stdlib.h"
+
+static const char *const nomes[INIC_MARCOS] = {
+  "perifericos",
+  "primeira amostra",
+  "primeiro quadro",
+};
+
+static uint64_t marcos[INIC_MARCOS];
+static bool relatado = false;
+
+void inicializacao_marcar_em(inic_marco_t marco, uint64_t instante_us) {
+  if (marcos[marco] == 0)
+    marcos[marco] = instante_us;
+}
+
+void inicializacao_marcar(inic_marco_t marco) {
+  inicializacao_marcar_em(marco, time_us_64());
+}
+
+void inicializacao_relatar(void) {
+  if (relatado)
+    return;
+  for (int m = 0; m < INIC_MARCOS; m++) {
+    if (marcos[m] == 0)
+      return;
+  }
+  relatado = true;
+
+  for (int m = 0; m < INIC_MARCOS; m++)
+    printf("Inicializacao: %s em %lu us\n", nomes[m], (unsigned long)marcos[m]);
+
+  if (marcos[INIC_PRIMEIRA_AMOSTRA] > INIC_ORCAMENTO_AMOSTRA_US)
+    printf("Inicializacao: primeira amostra acima do orcamento de %lu us\n",
+           (unsigned long)INIC_ORCAMENTO_AMOSTRA_US);
+  if (marcos[INIC_PRIMEIRO_QUADRO] > INIC_ORCAMENTO_QUADRO_US)
+    printf("Inicializacao: primeiro quadro acima do orcamento de %lu us\n",
+           (unsigned long)INIC_ORCAMENTO_QUADRO_US);
+}
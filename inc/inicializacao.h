@@ -0,0 +1,25 @@
+#ifndef INICIALIZACAO_H
+#define INICIALIZACAO_H
+
+#include <stdint.h>
+
+// Instrumentação da inicialização: registra quanto tempo após o reset cada marco foi
+// atingido e compara com o orçamento. O tempo conta a partir do início do timer (após a
+// boot ROM), que é zerado em qualquer reset, inclusive por brown-out ou watchdog.
+
+#define INIC_ORCAMENTO_AMOSTRA_US 50000   // Primeira amostra em até 50 ms
+#define INIC_ORCAMENTO_QUADRO_US 150000   // Primeiro quadro no display em até 150 ms
+#define INIC_ESPERA_SENSORES_US 1000000   // Sem leitura de sensor até aqui: vale a amostra do joystick
+
+typedef enum {
+  INIC_PERIFERICOS,        // Periféricos de amostragem prontos
+  INIC_PRIMEIRA_AMOSTRA,   // Primeira leitura válida do AHT20 ou do SGP30
+  INIC_PRIMEIRO_QUADRO,    // Primeiro quadro transmitido ao display
+  INIC_MARCOS
+} inic_marco_t;
+
+void inicializacao_marcar(inic_marco_t marco);                   // Só o primeiro registro vale
+void inicializacao_marcar_em(inic_marco_t marco, uint64_t instante_us);
+void inicializacao_relatar(void);                                // Imprime uma vez, com todos os marcos
+
+#endif // INICIALIZACAO_H
@@ -12,6 +12,15 @@ extern bool simbolo_perigo[LED_CONTAGEM];
 // Função para configurar os LEDs conforme um número específico
 void set_one_led(uint8_t r, uint8_t g, uint8_t b, bool numero_desenhado[]);
 
+// Função para acender cada LED com uma cor própria (cores no formato de cor_led)
+void set_leds_cores(const uint32_t cores[LED_CONTAGEM]);
+
+// Monta a cor no formato GRB esperado pelos WS2812
+static inline uint32_t cor_led(uint8_t r, uint8_t g, uint8_t b)
+{
+    return ((uint32_t)(r) << 8) | ((uint32_t)(g) << 16) | (uint32_t)(b);
+}
+
 // Função para exibir o número baseado no contador
 void mostra_numero_baseado_no_contador();
 
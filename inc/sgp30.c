@@ -0,0 +1,125 @@
+#include "sgp30.h"
+#include "i2c_fila.h"
+#include "crc8.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#define SGP30_ESPERA_INIT_MS 10
+#define SGP30_ESPERA_MEDICAO_MS 12
+
+typedef enum {
+  SGP30_OCIOSO,
+  SGP30_INICIALIZANDO,
+  SGP30_MEDINDO,
+} sgp30_estado_t;
+
+static struct {
+  volatile sgp30_estado_t estado;
+  volatile bool iniciado;
+  volatile bool presente;
+  volatile uint16_t tvoc;
+  volatile uint16_t eco2;
+  volatile uint64_t primeira_leitura_us;
+  uint8_t leitura[6];  // eCO2 (MSB, LSB, CRC), TVOC (MSB, LSB, CRC)
+  repeating_timer_t timer;
+} sgp30;
+
+static void sgp30_falha(void) {
+  sgp30.presente = false;
+  sgp30.iniciado = false;
+  sgp30.estado = SGP30_OCIOSO;
+}
+
+static void sgp30_leitura_concluida(bool ok, void *ctx) {
+  if (!ok) {
+    sgp30_falha();
+    return;
+  }
+
+  const uint8_t *b = sgp30.leitura;
+  if (crc8_sensor(&b[0], 2) == b[2] && crc8_sensor(&b[3], 2) == b[5]) {
+    sgp30.eco2 = ((uint16_t)b[0] << 8) | b[1];
+    sgp30.tvoc = ((uint16_t)b[3] << 8) | b[4];
+    sgp30.presente = true;
+    if (!sgp30.primeira_leitura_us)
+      sgp30.primeira_leitura_us = time_us_64();
+  }
+  sgp30.estado = SGP30_OCIOSO;
+}
+
+static int64_t sgp30_alarme_leitura(alarm_id_t id, void *ctx) {
+  if (!i2c_fila_ler(SGP30_ADDR, sgp30.leitura, sizeof(sgp30.leitura), I2C_PRIORIDADE_ALTA,
+                    sgp30_leitura_concluida, NULL))
+    sgp30.estado = SGP30_OCIOSO;
+  return 0;
+}
+
+static bool sgp30_periodo(repeating_timer_t *timer);
+
+// Primeira medição logo após a inicialização; as seguintes seguem o timer de 1 s
+static int64_t sgp30_alarme_init(alarm_id_t id, void *ctx) {
+  sgp30.iniciado = true;
+  sgp30.estado = SGP30_OCIOSO;
+  sgp30_periodo(&sgp30.timer);
+  return 0;
+}
+
+static void sgp30_comando_enviado(bool ok, void *ctx) {
+  if (!ok) {
+    sgp30_falha();
+    return;
+  }
+  if (sgp30.estado == SGP30_INICIALIZANDO)
+    add_alarm_in_ms(SGP30_ESPERA_INIT_MS, sgp30_alarme_init, NULL, true);
+  else
+    add_alarm_in_ms(SGP30_ESPERA_MEDICAO_MS, sgp30_alarme_leitura, NULL, true);
+}
+
+// Disparado a cada segundo: Init_air_quality na primeira vez, depois Measure_air_quality
+static bool sgp30_periodo(repeating_timer_t *timer) {
+  if (sgp30.estado != SGP30_OCIOSO)
+    return true;
+
+  static const uint8_t init[] = { 0x20, 0x03 };
+  static const uint8_t medir[] = { 0x20, 0x08 };
+  sgp30.estado = sgp30.iniciado ? SGP30_MEDINDO : SGP30_INICIALIZANDO;
+  const uint8_t *cmd = sgp30.iniciado ? medir : init;
+  if (!i2c_fila_escrever(SGP30_ADDR, cmd, 2, I2C_PRIORIDADE_ALTA, sgp30_comando_enviado, NULL))
+    sgp30.estado = SGP30_OCIOSO;
+  return true;
+}
+
+// Requer a fila I2C já inicializada. Init_air_quality é enviado já, sem esperar o timer
+void sgp30_iniciar(void) {
+  sgp30.estado = SGP30_OCIOSO;
+  sgp30.iniciado = false;
+  sgp30.presente = false;
+  sgp30.primeira_leitura_us = 0;
+  add_repeating_timer_ms(SGP30_PERIODO_MS, sgp30_periodo, NULL, &sgp30.timer);
+  sgp30_periodo(&sgp30.timer);
+}
+
+bool sgp30_presente(void) {
+  return sgp30.presente;
+}
+
+// Escrito na interrupção I2C: leitura de 64 bits com as interrupções mascaradas
+uint64_t sgp30_primeira_leitura(void) {
+  uint32_t estado = save_and_disable_interrupts();
+  uint64_t instante = sgp30.primeira_leitura_us;
+  restore_interrupts(estado);
+  return instante;
+}
+
+uint16_t sgp30_tvoc(void) {
+  return sgp30.tvoc;
+}
+
+uint16_t sgp30_eco2(void) {
+  return sgp30.eco2;
+}
+
+int sgp30_qualidade_ar(void) {
+  uint16_t tvoc = MIN(sgp30.tvoc, SGP30_TVOC_PESSIMO);
+  return 100 - (tvoc * 100) / SGP30_TVOC_PESSIMO;
+}
@@ -0,0 +1,21 @@
+#ifndef SGP30_H
+#define SGP30_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Sensor de qualidade do ar SGP30 (TVOC/eCO2), lido pela fila I2C sem bloquear.
+// O algoritmo interno do sensor exige uma medição por segundo.
+
+#define SGP30_ADDR 0x58
+#define SGP30_PERIODO_MS 1000
+#define SGP30_TVOC_PESSIMO 1000  // TVOC (ppb) correspondente a 0% de qualidade do ar
+
+void sgp30_iniciar(void);
+bool sgp30_presente(void);      // Verdadeiro após a primeira leitura válida
+uint64_t sgp30_primeira_leitura(void);  // Instante da primeira leitura válida (0 = nenhuma)
+uint16_t sgp30_tvoc(void);      // ppb
+uint16_t sgp30_eco2(void);      // ppm
+int sgp30_qualidade_ar(void);   // 0 (pior) a 100 (melhor)
+
+#endif // SGP30_H
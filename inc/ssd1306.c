@@ -1,196 +1,195 @@
+#include <string.h>
 #include "ssd1306.h"
 #include "font.h"
+#include "i2c_fila.h"
+#include "hardware/sync.h"
 
-void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
+// O buffer deve ter SSD1306_BUFSIZE(width, height) bytes (ver SSD1306_PAINEL)
+void ssd1306_init(ssd1306_t *ssd, uint8_t *buffer, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
   ssd->width = width;
   ssd->height = height;
-  ssd->pages = height / 8U;
+  ssd->pages = SSD1306_PAGES(height);
+  ssd->col_offset = (128U - width) / 2U;
   ssd->address = address;
   ssd->i2c_port = i2c;
-  ssd->bufsize = ssd->pages * ssd->width + 1;
-  ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->external_vcc = external_vcc;
+  ssd->bufsize = SSD1306_BUFSIZE(width, height);
+  ssd->ram_buffer = buffer;
+  memset(ssd->ram_buffer, 0, ssd->bufsize);
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->assincrono = false;
+  ssd->enviando = false;
+  ssd->ultimo_quadro_us = 0;
 }
 
-void ssd1306_config(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_DISP | 0x00);
-  ssd1306_command(ssd, SET_MEM_ADDR);
-  ssd1306_command(ssd, 0x01);
-  ssd1306_command(ssd, SET_DISP_START_LINE | 0x00);
-  ssd1306_command(ssd, SET_SEG_REMAP | 0x01);
-  ssd1306_command(ssd, SET_MUX_RATIO);
-  ssd1306_command(ssd, HEIGHT - 1);
-  ssd1306_command(ssd, SET_COM_OUT_DIR | 0x08);
-  ssd1306_command(ssd, SET_DISP_OFFSET);
-  ssd1306_command(ssd, 0x00);
-  ssd1306_command(ssd, SET_COM_PIN_CFG);
-  ssd1306_command(ssd, 0x12);
-  ssd1306_command(ssd, SET_DISP_CLK_DIV);
-  ssd1306_command(ssd, 0x80);
-  ssd1306_command(ssd, SET_PRECHARGE);
-  ssd1306_command(ssd, 0xF1);
-  ssd1306_command(ssd, SET_VCOM_DESEL);
-  ssd1306_command(ssd, 0x30);
-  ssd1306_command(ssd, SET_CONTRAST);
-  ssd1306_command(ssd, 0xFF);
-  ssd1306_command(ssd, SET_ENTIRE_ON);
-  ssd1306_command(ssd, SET_NORM_INV);
-  ssd1306_command(ssd, SET_CHARGE_PUMP);
-  ssd1306_command(ssd, 0x14);
-  ssd1306_command(ssd, SET_DISP | 0x01);
-}
-
-void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
+bool ssd1306_config(ssd1306_t *ssd) {
+  const uint8_t comandos[SSD1306_CONFIG_LEN] = {
+    SET_DISP | 0x00,
+    SET_MEM_ADDR, 0x01,
+    SET_DISP_START_LINE | 0x00,
+    SET_SEG_REMAP | 0x01,
+    SET_MUX_RATIO, ssd->height - 1,
+    SET_COM_OUT_DIR | 0x08,
+    SET_DISP_OFFSET, 0x00,
+    SET_COM_PIN_CFG, ssd->height == 32 ? 0x02 : 0x12,  // Painéis de 32 linhas usam COM sequencial
+    SET_DISP_CLK_DIV, 0x80,
+    SET_PRECHARGE, 0xF1,
+    SET_VCOM_DESEL, 0x30,
+    SET_CONTRAST, 0xFF,
+    SET_ENTIRE_ON,
+    SET_NORM_INV,
+    SET_CHARGE_PUMP, ssd->external_vcc ? 0x10 : 0x14,
+    SET_DISP | 0x01,
+  };
+
+  if (ssd->assincrono) {
+    // Uma única transação na fila: byte de controle 0x00 seguido da sequência de comandos
+    memcpy(ssd->config_buffer, comandos, SSD1306_CONFIG_LEN);
+    i2c_transacao_t t = {
+      .endereco = ssd->address,
+      .tx_curto = { 0x00 },
+      .tx_curto_len = 1,
+      .tx = ssd->config_buffer,
+      .tx_len = SSD1306_CONFIG_LEN,
+    };
+    return i2c_fila_enviar(&t, I2C_PRIORIDADE_BAIXA);
+  }
+
+  for (uint8_t i = 0; i < SSD1306_CONFIG_LEN; i++) {
+    if (!ssd1306_command(ssd, comandos[i]))
+      return false;
+  }
+  return true;
+}
+
+// Pela fila, o comando é só enfileirado: falso quando não há espaço (nada foi enviado)
+bool ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   ssd->port_buffer[1] = command;
-  i2c_write_blocking(
+  if (ssd->assincrono)
+    return i2c_fila_escrever(ssd->address, ssd->port_buffer, 2, I2C_PRIORIDADE_BAIXA, NULL, NULL);
+  return i2c_write_blocking(
     ssd->i2c_port,
     ssd->address,
     ssd->port_buffer,
     2,
     false
-  );
+  ) == 2;
+}
+
+static void ssd1306_quadro_enviado(bool ok, void *ctx) {
+  ssd1306_t *ssd = ctx;
+  if (ok)
+    ssd->ultimo_quadro_us = time_us_64();
+  ssd->enviando = false;
+}
+
+// Envia o quadro pela fila: janela de endereçamento + blocos do buffer com byte de controle 0x40
+static bool ssd1306_send_data_fila(ssd1306_t *ssd) {
+  size_t dados = ssd->bufsize - 1;
+  uint32_t blocos = (dados + SSD1306_BLOCO_FILA - 1) / SSD1306_BLOCO_FILA;
+  if (ssd->enviando || i2c_fila_livres(I2C_PRIORIDADE_BAIXA) < blocos + 1)
+    return false;  // Descarta o quadro em vez de bloquear
+  ssd->enviando = true;
+
+  i2c_transacao_t t = {
+    .endereco = ssd->address,
+    .tx_curto = { 0x00, SET_COL_ADDR, ssd->col_offset, ssd->col_offset + ssd->width - 1,
+                  SET_PAGE_ADDR, 0, ssd->pages - 1 },
+    .tx_curto_len = 7,
+  };
+  i2c_fila_enviar(&t, I2C_PRIORIDADE_BAIXA);
+
+  t.tx_curto[0] = 0x40;
+  t.tx_curto_len = 1;
+  for (size_t pos = 0; pos < dados; pos += SSD1306_BLOCO_FILA) {
+    t.tx = &ssd->ram_buffer[1 + pos];
+    t.tx_len = MIN(SSD1306_BLOCO_FILA, dados - pos);
+    bool ultimo = pos + SSD1306_BLOCO_FILA >= dados;
+    t.callback = ultimo ? ssd1306_quadro_enviado : NULL;
+    t.ctx = ultimo ? ssd : NULL;
+    i2c_fila_enviar(&t, I2C_PRIORIDADE_BAIXA);
+  }
+  return true;
 }
 
-void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
+bool ssd1306_send_data(ssd1306_t *ssd) {
+  if (ssd->assincrono)
+    return ssd1306_send_data_fila(ssd);
+  const uint8_t janela[] = {
+    SET_COL_ADDR, ssd->col_offset, ssd->col_offset + ssd->width - 1,
+    SET_PAGE_ADDR, 0, ssd->pages - 1,
+  };
+  for (uint8_t i = 0; i < sizeof(janela); i++) {
+    if (!ssd1306_command(ssd, janela[i]))
+      return false;  // Sem a janela o quadro sairia deslocado
+  }
+  return i2c_write_blocking(
     ssd->i2c_port,
     ssd->address,
     ssd->ram_buffer,
     ssd->bufsize,
     false
-  );
+  ) == (int)ssd->bufsize;
 }
 
-void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
-  uint16_t index = (y >> 3) + (x << 3) + 1;
-  uint8_t pixel = (y & 0b111);
-  if (value)
-    ssd->ram_buffer[index] |= (1 << pixel);
-  else
-    ssd->ram_buffer[index] &= ~(1 << pixel);
+// Passa a enviar comandos e quadros pela fila I2C (chamar depois de i2c_fila_init)
+void ssd1306_usar_fila(ssd1306_t *ssd) {
+  ssd->assincrono = true;
+  ssd->enviando = false;
 }
 
-/*
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-  uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
-    ssd->ram_buffer[i] = byte;
-}*/
-
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
-    }
+bool ssd1306_ocupado(ssd1306_t *ssd) {
+  return ssd->enviando;
 }
 
+// ultimo_quadro_us é escrito na interrupção I2C; a leitura de 64 bits no M0+ precisa das
+// interrupções mascaradas para não misturar metades de dois quadros
+uint64_t ssd1306_ultimo_quadro(ssd1306_t *ssd) {
+  uint32_t estado = save_and_disable_interrupts();
+  uint64_t instante = ssd->ultimo_quadro_us;
+  restore_interrupts(estado);
+  return instante;
+}
 
+// Preenche o buffer inteiro de uma vez (cada byte cobre 8 linhas de uma coluna)
+void ssd1306_fill(ssd1306_t *ssd, bool value) {
+  memset(ssd->ram_buffer + 1, value ? 0xFF : 0x00, ssd->bufsize - 1);
+}
 
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
-  for (uint8_t x = left; x < left + width; ++x) {
-    ssd1306_pixel(ssd, x, top, value);
-    ssd1306_pixel(ssd, x, top + height - 1, value);
-  }
-  for (uint8_t y = top; y < top + height; ++y) {
-    ssd1306_pixel(ssd, left, y, value);
-    ssd1306_pixel(ssd, left + width - 1, y, value);
-  }
-
-  if (fill) {
-    for (uint8_t x = left + 1; x < left + width - 1; ++x) {
-      for (uint8_t y = top + 1; y < top + height - 1; ++y) {
-        ssd1306_pixel(ssd, x, y, value);
-      }
-    }
-  }
+  ssd1306_rect_com(ssd, ssd1306_pixel, top, left, width, height, value, fill);
 }
 
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) {
-    int dx = abs(x1 - x0);
-    int dy = abs(y1 - y0);
-
-    int sx = (x0 < x1) ? 1 : -1;
-    int sy = (y0 < y1) ? 1 : -1;
-
-    int err = dx - dy;
-
-    while (true) {
-        ssd1306_pixel(ssd, x0, y0, value); // Desenha o pixel atual
-
-        if (x0 == x1 && y0 == y1) break; // Termina quando alcança o ponto final
-
-        int e2 = err * 2;
-
-        if (e2 > -dy) {
-            err -= dy;
-            x0 += sx;
-        }
-
-        if (e2 < dx) {
-            err += dx;
-            y0 += sy;
-        }
-    }
+  ssd1306_line_com(ssd, ssd1306_pixel, x0, y0, x1, y1, value);
 }
 
-
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-  for (uint8_t x = x0; x <= x1; ++x)
-    ssd1306_pixel(ssd, x, y, value);
+  ssd1306_hline_com(ssd, ssd1306_pixel, x0, x1, y, value);
 }
 
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-  for (uint8_t y = y0; y <= y1; ++y)
-    ssd1306_pixel(ssd, x, y, value);
+  ssd1306_vline_com(ssd, ssd1306_pixel, x, y0, y1, value);
 }
 
-// Função para desenhar um caractere
-void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
-{
+// Fonte com A-Z e 0-9; os demais caracteres usam o glifo vazio do início da tabela
+const uint8_t *ssd1306_glifo(char c) {
   uint16_t index = 0;
-  char ver=c;
-  if (c >= 'A' && c <= 'Z')
-  {
-    index = (c - 'A' + 11) * 8; // Para letras maiúsculas
-  }else  if (c >= '0' && c <= '9')
-  {
-    index = (c - '0' + 1) * 8; // Adiciona o deslocamento necessário
-  }
-  
-  for (uint8_t i = 0; i < 8; ++i)
-  {
-    uint8_t line = font[index + i];
-    for (uint8_t j = 0; j < 8; ++j)
-    {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j));
-    }
+  if (c >= 'A' && c <= 'Z') {
+    index = (c - 'A' + 11) * 8;  // Para letras maiúsculas
+  } else if (c >= '0' && c <= '9') {
+    index = (c - '0' + 1) * 8;   // Adiciona o deslocamento necessário
   }
+  return &font[index];
+}
+
+// Função para desenhar um caractere
+void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y) {
+  ssd1306_draw_char_com(ssd, ssd1306_pixel, c, x, y);
 }
 
 // Função para desenhar uma string
-void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
-{
-  while (*str)
-  {
-    ssd1306_draw_char(ssd, *str++, x, y);
-    x += 8;
-    if (x + 8 >= ssd->width)
-    {
-      x = 0;
-      y += 8;
-    }
-    if (y + 8 >= ssd->height)
-    {
-      break;
-    }
-  }
-}
\ No newline at end of file
+void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y) {
+  ssd1306_draw_string_com(ssd, ssd1306_pixel, ssd->width, ssd->height, str, x, y);
+}
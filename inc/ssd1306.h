@@ -1,9 +1,29 @@
+#ifndef SSD1306_H
+#define SSD1306_H
+
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 
-#define WIDTH 128
-#define HEIGHT 64
+// Geometrias suportadas (largura x altura em pixels)
+#define SSD1306_128X64_LARGURA 128
+#define SSD1306_128X64_ALTURA 64
+#define SSD1306_128X32_LARGURA 128
+#define SSD1306_128X32_ALTURA 32
+#define SSD1306_64X48_LARGURA 64
+#define SSD1306_64X48_ALTURA 48
+
+// Cálculos de geometria resolvidos em tempo de compilação quando os argumentos são constantes
+#define SSD1306_PAGES(altura) ((altura) / 8U)
+#define SSD1306_BUFSIZE(largura, altura) ((largura) * SSD1306_PAGES(altura) + 1U)
+// Modo de endereçamento vertical: cada coluna ocupa 'pages' bytes consecutivos (+1 do byte de controle)
+#define SSD1306_INDEX(pages, x, y) ((uint16_t)(x) * (pages) + ((y) >> 3) + 1U)
+
+// Tamanho dos blocos do quadro enviados pela fila I2C (sensores são atendidos entre blocos)
+#define SSD1306_BLOCO_FILA 32
+
+// Bytes da sequência de inicialização enviada por ssd1306_config
+#define SSD1306_CONFIG_LEN 25
 
 typedef enum {
   SET_CONTRAST = 0x81,
@@ -27,23 +47,175 @@ typedef enum {
 
 typedef struct {
   uint8_t width, height, pages, address;
+  uint8_t col_offset;  // Primeira coluna visível na RAM do controlador (32 nos painéis 64x48)
   i2c_inst_t *i2c_port;
   bool external_vcc;
   uint8_t *ram_buffer;
   size_t bufsize;
   uint8_t port_buffer[2];
+  bool assincrono;         // Envia pela fila I2C em vez de bloquear
+  volatile bool enviando;  // Quadro ainda na fila; não redesenhar o buffer
+  volatile uint64_t ultimo_quadro_us;          // Fim do envio do último quadro pela fila
+  uint8_t config_buffer[SSD1306_CONFIG_LEN];   // Comandos de configuração aguardando a fila
 } ssd1306_t;
 
-void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
-void ssd1306_config(ssd1306_t *ssd);
-void ssd1306_command(ssd1306_t *ssd, uint8_t command);
-void ssd1306_send_data(ssd1306_t *ssd);
+void ssd1306_init(ssd1306_t *ssd, uint8_t *buffer, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
+bool ssd1306_config(ssd1306_t *ssd);
+bool ssd1306_command(ssd1306_t *ssd, uint8_t command);  // Falso se a fila I2C estiver cheia ou houver NACK
+bool ssd1306_send_data(ssd1306_t *ssd);  // Falso se o quadro foi descartado (fila cheia ou anterior em envio)
+void ssd1306_usar_fila(ssd1306_t *ssd);
+bool ssd1306_ocupado(ssd1306_t *ssd);
+uint64_t ssd1306_ultimo_quadro(ssd1306_t *ssd);  // Fim do último envio pela fila (0 = nenhum)
+
+// Escrita de pixel com a geometria da estrutura: serve a qualquer painel. Para a geometria
+// em constantes, use as funções geradas por SSD1306_PAINEL.
+static inline void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
+  if (x >= ssd->width || y >= ssd->height)
+    return;
+  uint8_t *byte = &ssd->ram_buffer[SSD1306_INDEX(ssd->pages, x, y)];
+  uint8_t mask = 1U << (y & 0b111);
+  if (value)
+    *byte |= mask;
+  else
+    *byte &= ~mask;
+}
 
-void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill);
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value);
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value);
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
-void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
\ No newline at end of file
+void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
+const uint8_t *ssd1306_glifo(char c);  // 8 colunas do caractere na fonte (espaço se ausente)
+
+// Primitivas de desenho escritas uma vez sobre uma função de pixel. As funções ssd1306_*
+// passam ssd1306_pixel; as de cada painel passam o nome##_pixel de geometria constante, que
+// o compilador expande no lugar.
+typedef void (*ssd1306_pixel_t)(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
+
+static inline void ssd1306_hline_com(ssd1306_t *ssd, ssd1306_pixel_t pixel, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
+  for (uint8_t x = x0; x <= x1; ++x)
+    pixel(ssd, x, y, value);
+}
+
+static inline void ssd1306_vline_com(ssd1306_t *ssd, ssd1306_pixel_t pixel, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
+  for (uint8_t y = y0; y <= y1; ++y)
+    pixel(ssd, x, y, value);
+}
+
+static inline void ssd1306_rect_com(ssd1306_t *ssd, ssd1306_pixel_t pixel, uint8_t top, uint8_t left,
+                                    uint8_t width, uint8_t height, bool value, bool fill) {
+  for (uint8_t x = left; x < left + width; ++x) {
+    pixel(ssd, x, top, value);
+    pixel(ssd, x, top + height - 1, value);
+  }
+  for (uint8_t y = top; y < top + height; ++y) {
+    pixel(ssd, left, y, value);
+    pixel(ssd, left + width - 1, y, value);
+  }
+
+  if (fill) {
+    for (uint8_t x = left + 1; x < left + width - 1; ++x) {
+      for (uint8_t y = top + 1; y < top + height - 1; ++y) {
+        pixel(ssd, x, y, value);
+      }
+    }
+  }
+}
+
+static inline void ssd1306_line_com(ssd1306_t *ssd, ssd1306_pixel_t pixel, uint8_t x0, uint8_t y0,
+                                    uint8_t x1, uint8_t y1, bool value) {
+  int dx = abs(x1 - x0);
+  int dy = abs(y1 - y0);
+  int sx = (x0 < x1) ? 1 : -1;
+  int sy = (y0 < y1) ? 1 : -1;
+  int err = dx - dy;
+
+  while (true) {
+    pixel(ssd, x0, y0, value);
+    if (x0 == x1 && y0 == y1)
+      break;
+    int e2 = err * 2;
+    if (e2 > -dy) {
+      err -= dy;
+      x0 += sx;
+    }
+    if (e2 < dx) {
+      err += dx;
+      y0 += sy;
+    }
+  }
+}
+
+static inline void ssd1306_draw_char_com(ssd1306_t *ssd, ssd1306_pixel_t pixel, char c, uint8_t x, uint8_t y) {
+  const uint8_t *glifo = ssd1306_glifo(c);
+  for (uint8_t i = 0; i < 8; ++i) {
+    uint8_t line = glifo[i];
+    for (uint8_t j = 0; j < 8; ++j)
+      pixel(ssd, x + i, y + j, line & (1 << j));
+  }
+}
+
+// Quebra a linha quando o próximo caractere não cabe e para quando a próxima linha não cabe
+// (a última coluna e a última linha de caracteres terminam exatamente na borda)
+static inline void ssd1306_draw_string_com(ssd1306_t *ssd, ssd1306_pixel_t pixel, uint8_t largura,
+                                           uint8_t altura, const char *str, uint8_t x, uint8_t y) {
+  while (*str) {
+    ssd1306_draw_char_com(ssd, pixel, *str++, x, y);
+    x += 8;
+    if (x + 8 > largura) {
+      x = 0;
+      y += 8;
+    }
+    if (y + 8 > altura)
+      break;
+  }
+}
+
+// Declara um painel: framebuffer estático (sem heap) do tamanho exato da geometria, função
+// de inicialização e primitivas de desenho com a geometria em constantes (o índice do buffer
+// vira deslocamentos, x << 3 no painel de 64 linhas). Painéis de geometrias diferentes
+// coexistem, cada um com suas funções; as funções ssd1306_* servem a qualquer um deles.
+//   SSD1306_PAINEL(oled, SSD1306_128X32_LARGURA, SSD1306_128X32_ALTURA)
+//   oled_init(&ssd, false, 0x3C, i2c1);
+//   oled_draw_string(&ssd, "OLA", 0, 0);
+#define SSD1306_PAINEL(nome, largura, altura)                                              \
+  _Static_assert((altura) % 8 == 0 && (altura) <= 64 && (largura) <= 128,                   \
+                 "Geometria SSD1306 invalida");                                            \
+  static uint8_t nome##_buffer[SSD1306_BUFSIZE(largura, altura)];                           \
+  static inline void nome##_init(ssd1306_t *ssd, bool external_vcc, uint8_t address, i2c_inst_t *i2c) { \
+    ssd1306_init(ssd, nome##_buffer, (largura), (altura), external_vcc, address, i2c);      \
+  }                                                                                         \
+  /* Escreve sempre no buffer do painel: ssd só é repassado para manter a assinatura */     \
+  static inline void nome##_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {       \
+    if (x >= (largura) || y >= (altura))                                                    \
+      return;                                                                               \
+    uint8_t *byte = &nome##_buffer[SSD1306_INDEX(SSD1306_PAGES(altura), x, y)];             \
+    uint8_t mask = 1U << (y & 0b111);                                                       \
+    if (value)                                                                              \
+      *byte |= mask;                                                                        \
+    else                                                                                    \
+      *byte &= ~mask;                                                                       \
+  }                                                                                         \
+  static inline void nome##_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) { \
+    ssd1306_hline_com(ssd, nome##_pixel, x0, x1, y, value);                                 \
+  }                                                                                         \
+  static inline void nome##_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) { \
+    ssd1306_vline_com(ssd, nome##_pixel, x, y0, y1, value);                                 \
+  }                                                                                         \
+  static inline void nome##_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width,  \
+                                 uint8_t height, bool value, bool fill) {                   \
+    ssd1306_rect_com(ssd, nome##_pixel, top, left, width, height, value, fill);             \
+  }                                                                                         \
+  static inline void nome##_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) { \
+    ssd1306_line_com(ssd, nome##_pixel, x0, y0, x1, y1, value);                             \
+  }                                                                                         \
+  static inline void nome##_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y) {       \
+    ssd1306_draw_char_com(ssd, nome##_pixel, c, x, y);                                      \
+  }                                                                                         \
+  static inline void nome##_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y) { \
+    ssd1306_draw_string_com(ssd, nome##_pixel, (largura), (altura), str, x, y);             \
+  }
+
+#endif // SSD1306_H
@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include "vigia.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
+
+typedef struct {
+  const char *nome;
+  uint32_t orcamento_ms;
+  uint32_t estouros;
+} vigia_etapa_t;
+
+static struct {
+  vigia_etapa_t etapas[VIGIA_MAX_ETAPAS];
+  uint32_t registradas;          // Bit por etapa registrada
+  volatile uint32_t checkins;    // Bit por etapa que fez check-in nesta iteração
+  uint32_t orcamento_laco_ms;
+  uint32_t laco_inicio_ms;
+  uint32_t estouros_laco;
+  uint32_t ultimo_estouro;       // Registro do último estouro, devolvido ao scratch quando os check-ins voltam
+  bool sem_checkin;              // VIGIA_SCRATCH_ULTIMO guarda as etapas sem check-in
+
+  volatile uint8_t etapa_atual;
+  volatile uint32_t etapa_inicio_ms;
+  volatile bool etapa_estourou;  // Estouro da etapa atual já contabilizado
+  alarm_id_t alarme;             // Prazo da etapa atual (0 = nenhum)
+} vigia;
+
+// Relógio e registradores do watchdog ficam só nestas funções; nos testes no host o SDK
+// simulado (test/sdk) fornece relógio virtual e registradores de scratch em memória
+static inline uint32_t agora_ms(void) {
+  return to_ms_since_boot(get_absolute_time());
+}
+
+static inline uint32_t scratch_ler(uint indice) {
+  return watchdog_hw->scratch[indice];
+}
+
+static inline void scratch_escrever(uint indice, uint32_t valor) {
+  watchdog_hw->scratch[indice] = valor;
+}
+
+static const char *vigia_nome(uint8_t etapa) {
+  if (etapa < VIGIA_MAX_ETAPAS && vigia.etapas[etapa].nome)
+    return vigia.etapas[etapa].nome;
+  return "laco";
+}
+
+// Chamada tanto pelo alarme quanto pelo laço: o incremento do contador no scratch é
+// leitura-modificação-escrita e não pode ser interrompido
+static void vigia_registrar_estouro(uint8_t etapa, uint32_t duracao_ms) {
+  uint32_t estado = save_and_disable_interrupts();
+  if (etapa < VIGIA_MAX_ETAPAS)
+    vigia.etapas[etapa].estouros++;
+  scratch_escrever(VIGIA_SCRATCH_ESTOUROS, scratch_ler(VIGIA_SCRATCH_ESTOUROS) + 1);
+  vigia.ultimo_estouro = vigia_codificar_estouro(etapa, duracao_ms);
+  if (!vigia.sem_checkin)  // A falta de check-in é o que vai causar o reset: não a sobrescreve
+    scratch_escrever(VIGIA_SCRATCH_ULTIMO, vigia.ultimo_estouro);
+  restore_interrupts(estado);
+}
+
+// Prazo da etapa esgotado: detecta a etapa presa antes do reset, enquanto ela ainda não
+// terminou. Só existe alarme com uma etapa em andamento; fora delas (no sono do laço, por
+// exemplo) o vigia não acorda o núcleo
+static int64_t vigia_prazo(alarm_id_t id, void *ctx) {
+  uint8_t etapa = (uint8_t)(uintptr_t)ctx;
+  if (id != vigia.alarme || etapa != vigia.etapa_atual || vigia.etapa_estourou)
+    return 0;  // Alarme de uma etapa que já terminou
+  vigia.alarme = 0;
+  vigia.etapa_estourou = true;
+  vigia_registrar_estouro(etapa, agora_ms() - vigia.etapa_inicio_ms);
+  return 0;
+}
+
+static void vigia_cancelar_prazo(void) {
+  if (vigia.alarme > 0)
+    cancel_alarm(vigia.alarme);
+  vigia.alarme = 0;
+}
+
+void vigia_registrar(uint8_t etapa, const char *nome, uint32_t orcamento_ms) {
+  if (etapa >= VIGIA_MAX_ETAPAS)
+    return;
+  vigia.etapas[etapa].nome = nome;
+  vigia.etapas[etapa].orcamento_ms = orcamento_ms;
+  vigia.registradas |= 1u << etapa;
+}
+
+void vigia_init(uint32_t orcamento_laco_ms) {
+  uint8_t etapa;
+  bool dados_validos = vigia_decodificar_etapa(scratch_ler(VIGIA_SCRATCH_ETAPA), &etapa);
+  uint32_t faltando = dados_validos ? vigia_sem_checkin(scratch_ler(VIGIA_SCRATCH_ULTIMO)) : 0;
+
+  if (watchdog_enable_caused_reboot()) {
+    // Watchdog deixado sem alimentação por falta de check-in: aponta quem faltou, além da
+    // etapa que estava em andamento
+    if (faltando) {
+      printf("Vigia: watchdog sem alimentacao, faltou check-in de");
+      for (uint8_t i = 0; i < VIGIA_MAX_ETAPAS; i++) {
+        if (faltando & (1u << i))
+          printf(" '%s'", vigia_nome(i));
+      }
+      printf("\n");
+    }
+    if (dados_validos) {
+      printf("Vigia: reset pelo watchdog na etapa '%s' (iniciada em %lu ms)\n", vigia_nome(etapa),
+             (unsigned long)scratch_ler(VIGIA_SCRATCH_INICIO));
+    } else {
+      printf("Vigia: reset pelo watchdog\n");
+    }
+  } else if (watchdog_caused_reboot()) {
+    printf("Vigia: reinicio solicitado por software\n");
+  } else {
+    printf("Vigia: reset por energizacao ou brown-out\n");
+    scratch_escrever(VIGIA_SCRATCH_ESTOUROS, 0);
+    scratch_escrever(VIGIA_SCRATCH_ULTIMO, 0);
+  }
+
+  // O registro da falta de check-in já foi relatado; o do estouro anterior se perdeu com ele
+  if (vigia_sem_checkin(scratch_ler(VIGIA_SCRATCH_ULTIMO)))
+    scratch_escrever(VIGIA_SCRATCH_ULTIMO, 0);
+  vigia.ultimo_estouro = scratch_ler(VIGIA_SCRATCH_ULTIMO);
+  vigia.sem_checkin = false;
+
+  uint32_t estouros = scratch_ler(VIGIA_SCRATCH_ESTOUROS);
+  uint32_t ultimo = vigia.ultimo_estouro;
+  if (estouros && ultimo) {
+    printf("Vigia: %lu estouros de prazo desde a energizacao, ultimo na etapa '%s' (%lu ms)\n",
+           (unsigned long)estouros, vigia_nome(vigia_estouro_etapa(ultimo)),
+           (unsigned long)vigia_estouro_duracao_ms(ultimo));
+  }
+
+  vigia.orcamento_laco_ms = orcamento_laco_ms;
+  vigia.etapa_atual = VIGIA_SEM_ETAPA;
+  vigia.etapa_estourou = false;
+  vigia.alarme = 0;
+  vigia.checkins = 0;
+  scratch_escrever(VIGIA_SCRATCH_ETAPA, vigia_codificar_etapa(VIGIA_SEM_ETAPA));
+  scratch_escrever(VIGIA_SCRATCH_INICIO, agora_ms());
+
+  watchdog_enable(VIGIA_TIMEOUT_MS, true);  // Pausa durante a depuração
+}
+
+void vigia_laco_inicio(void) {
+  vigia.laco_inicio_ms = agora_ms();
+  vigia.checkins = 0;
+}
+
+// Troca de etapa com o alarme mascarado: vigia_prazo nunca vê o início de uma etapa junto
+// com a marca de estouro da anterior. O alarme vence 1 ms após o orçamento, o primeiro
+// instante em que a etapa já estourou
+void vigia_etapa_inicio(uint8_t etapa) {
+  uint32_t estado = save_and_disable_interrupts();
+  uint32_t agora = agora_ms();
+  vigia_cancelar_prazo();
+  vigia.etapa_estourou = false;
+  vigia.etapa_inicio_ms = agora;
+  vigia.etapa_atual = etapa;
+  vigia.alarme = add_alarm_in_ms(vigia.etapas[etapa].orcamento_ms + 1, vigia_prazo,
+                                 (void *)(uintptr_t)etapa, false);
+  scratch_escrever(VIGIA_SCRATCH_INICIO, agora);
+  scratch_escrever(VIGIA_SCRATCH_ETAPA, vigia_codificar_etapa(etapa));
+  restore_interrupts(estado);
+}
+
+void vigia_etapa_fim(uint8_t etapa) {
+  // Teste e registro do estouro sem que vigia_prazo possa registrá-lo no meio. O alarme pode
+  // ter vencido sem disparar (interrupções mascaradas na etapa): conta aqui e o cancela
+  uint32_t estado = save_and_disable_interrupts();
+  uint32_t duracao = agora_ms() - vigia.etapa_inicio_ms;
+  bool estourou = duracao > vigia.etapas[etapa].orcamento_ms;
+  bool ja_contado = vigia.etapa_estourou;
+  vigia_cancelar_prazo();
+  vigia.etapa_atual = VIGIA_SEM_ETAPA;
+  if (estourou && !ja_contado)
+    vigia_registrar_estouro(etapa, duracao);
+  restore_interrupts(estado);
+
+  if (estourou)
+    printf("Vigia: etapa '%s' levou %lu ms (orcamento %lu ms, %lu estouros)\n", vigia_nome(etapa),
+           (unsigned long)duracao, (unsigned long)vigia.etapas[etapa].orcamento_ms,
+           (unsigned long)vigia.etapas[etapa].estouros);
+
+  vigia_checkin(etapa);
+}
+
+void vigia_checkin(uint8_t etapa) {
+  vigia.checkins |= 1u << etapa;
+}
+
+void vigia_laco_fim(void) {
+  uint32_t duracao = agora_ms() - vigia.laco_inicio_ms;
+  if (duracao > vigia.orcamento_laco_ms) {
+    vigia.estouros_laco++;
+    vigia_registrar_estouro(VIGIA_SEM_ETAPA, duracao);
+    printf("Vigia: laco levou %lu ms (orcamento %lu ms)\n", (unsigned long)duracao,
+           (unsigned long)vigia.orcamento_laco_ms);
+  }
+
+  // Alguma tarefa não fez check-in: deixa o watchdog expirar, com o motivo gravado para a
+  // próxima inicialização
+  uint32_t faltando = vigia.registradas & ~vigia.checkins;
+  uint32_t estado = save_and_disable_interrupts();
+  if (faltando) {
+    vigia.sem_checkin = true;
+    scratch_escrever(VIGIA_SCRATCH_ULTIMO, vigia_codificar_sem_checkin(faltando));
+  } else if (vigia.sem_checkin) {
+    vigia.sem_checkin = false;
+    scratch_escrever(VIGIA_SCRATCH_ULTIMO, vigia.ultimo_estouro);
+  }
+  restore_interrupts(estado);
+  if (faltando)
+    return;
+  watchdog_update();
+}
+
+uint32_t vigia_estouros(void) {
+  return scratch_ler(VIGIA_SCRATCH_ESTOUROS);
+}
@@ -0,0 +1,73 @@
+#ifndef VIGIA_H
+#define VIGIA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Monitor de prazos do laço principal apoiado no watchdog. Cada etapa do laço tem um
+// orçamento de tempo; o watchdog só é alimentado quando todas as etapas registradas fizeram
+// check-in na iteração. A etapa em andamento fica gravada nos registradores de scratch do
+// watchdog (preservados no reset), de modo que após um travamento a próxima inicialização
+// informa onde e quando o sistema parou. O prazo de cada etapa é um alarme único armado no
+// início e cancelado no fim; fora das etapas o vigia não acorda o núcleo.
+
+#define VIGIA_MAX_ETAPAS 8
+#define VIGIA_TIMEOUT_MS 8000          // Máximo do RP2040 é ~8,3 s
+#define VIGIA_SEM_ETAPA 0xFF
+#define VIGIA_SEM_CHECKIN 0xFE   // Em VIGIA_SCRATCH_ULTIMO: etapas sem check-in no lugar da duração
+
+// Registradores de scratch 0 a 3 (o SDK usa os de 4 a 7)
+#define VIGIA_SCRATCH_ETAPA 0       // Marca | etapa em andamento
+#define VIGIA_SCRATCH_INICIO 1      // Início da etapa em andamento (ms desde o boot)
+#define VIGIA_SCRATCH_ESTOUROS 2    // Estouros acumulados desde a energização
+#define VIGIA_SCRATCH_ULTIMO 3      // Etapa (8 bits altos) e duração em ms do último estouro, ou
+                                    // VIGIA_SEM_CHECKIN e as etapas que seguram o watchdog
+#define VIGIA_MARCA 0x56470000u     // "VG" nos 16 bits altos identifica dados válidos
+#define VIGIA_DURACAO_MAX 0xFFFFFFu // Durações maiores ficam saturadas (~4,6 h)
+
+static inline uint32_t vigia_codificar_etapa(uint8_t etapa) {
+  return VIGIA_MARCA | etapa;
+}
+
+// Falso se o registrador não tem a marca (energização ou outro firmware)
+static inline bool vigia_decodificar_etapa(uint32_t valor, uint8_t *etapa) {
+  if ((valor & 0xFFFF0000u) != VIGIA_MARCA)
+    return false;
+  *etapa = valor & 0xFF;
+  return true;
+}
+
+static inline uint32_t vigia_codificar_estouro(uint8_t etapa, uint32_t duracao_ms) {
+  return ((uint32_t)etapa << 24) | (duracao_ms > VIGIA_DURACAO_MAX ? VIGIA_DURACAO_MAX : duracao_ms);
+}
+
+static inline uint8_t vigia_estouro_etapa(uint32_t valor) {
+  return valor >> 24;
+}
+
+static inline uint32_t vigia_estouro_duracao_ms(uint32_t valor) {
+  return valor & VIGIA_DURACAO_MAX;
+}
+
+// Bit por etapa que não fez check-in (as etapas cabem nos 24 bits baixos)
+static inline uint32_t vigia_codificar_sem_checkin(uint32_t faltando) {
+  return ((uint32_t)VIGIA_SEM_CHECKIN << 24) | (faltando & ((1u << VIGIA_MAX_ETAPAS) - 1));
+}
+
+// Zero se o registro é de um estouro de prazo
+static inline uint32_t vigia_sem_checkin(uint32_t valor) {
+  if (vigia_estouro_etapa(valor) != VIGIA_SEM_CHECKIN)
+    return 0;
+  return valor & ((1u << VIGIA_MAX_ETAPAS) - 1);
+}
+
+void vigia_registrar(uint8_t etapa, const char *nome, uint32_t orcamento_ms);
+void vigia_init(uint32_t orcamento_laco_ms);   // Relata o último reset e arma o watchdog
+void vigia_laco_inicio(void);
+void vigia_etapa_inicio(uint8_t etapa);
+void vigia_etapa_fim(uint8_t etapa);           // Fim da etapa conta como check-in
+void vigia_checkin(uint8_t etapa);             // Check-in de tarefas sem duração (ex.: saúde do I2C)
+void vigia_laco_fim(void);                     // Alimenta o watchdog se todos fizeram check-in
+uint32_t vigia_estouros(void);
+
+#endif // VIGIA_H
@@ -7,8 +7,17 @@
 #include "hardware/i2c.h"
 #include "inc/ssd1306.h"
 #include "inc/font.h"
+#include "hardware/sync.h"
 #include "ws2812.pio.h"
 #include "inc/led_matriz.h"// Onde estão os caracteres armazenados para mostrar no display
+#include "inc/i2c_fila.h"
+#include "inc/aht20.h"
+#include "inc/sgp30.h"
+#include "inc/energia.h"
+#include "inc/calibracao.h"
+#include "inc/abrigos.h"
+#include "inc/inicializacao.h"
+#include "inc/vigia.h"
 #include <time.h>
 #include <stdint.h>
 #include <stdbool.h>
@@ -28,19 +37,64 @@
 #define LED_RED 13     // Pino do LED vermelho
 #define JOYSTICK_X_PIN 26   // Pino do eixo X do joystick
 #define JOYSTICK_Y_PIN 27   // Pino do eixo Y do joystick
-#define JOYSTICK_DEADZONE 40  // Zona morta do joystick
 #define BUZZER_PIN 21  // Zona morta do joystick
 // Frequência do buzzer (em Hz)
 // Frequência do buzzer (em Hz)
 #define BUZZER_FREQUENCY 1000  // Frequência padrão do buzzer
 
-// Ajuste do centro do joystick
-#define JOYSTICK_CENTER_X 1939 // Valor de centro do eixo X
-#define JOYSTICK_CENTER_Y 2180 // Valor de centro do eixo Y
-
-// Parâmetros da tela e exibição
-#define SCREEN_WIDTH 128 // Largura da tela
-#define SCREEN_HEIGHT 64 // Altura da tela
+// Quantidade de abrigos supervisionados (o abrigo 0 é o local; os demais são remotos)
+#ifndef ABRIGOS_QUANTIDADE
+#define ABRIGOS_QUANTIDADE 1
+#endif
+_Static_assert(ABRIGOS_QUANTIDADE >= 1 && ABRIGOS_QUANTIDADE <= ABRIGOS_MAX,
+               "ABRIGOS_QUANTIDADE deve estar entre 1 e ABRIGOS_MAX");
+#define PAGINA_MS 4000  // Tempo de exibição de cada página do resumo de abrigos
+#define SPLASH_MS 5000  // Tempo da mensagem de boas-vindas (a amostragem não espera por ela)
+#define ALERTA_TELA_MS 5000  // Tempo da tela de contaminação
+
+// Etapas do laço principal acompanhadas pelo vigia (watchdog) e seus orçamentos
+enum {
+    ETAPA_AMOSTRAGEM,  // Leituras, bipes de temperatura/ar e recalibração
+    ETAPA_ALERTAS,
+    ETAPA_DISPLAY,
+    ETAPA_LEDS,        // Inclui o pisca de 1 s do símbolo de perigo
+    ETAPA_SONO,
+    ETAPA_I2C,         // Check-in apenas: fila I2C sem transação presa
+};
+#define ORCAMENTO_AMOSTRAGEM_MS 1500
+#define ORCAMENTO_ALERTAS_MS 1000
+#define ORCAMENTO_DISPLAY_MS 100
+#define ORCAMENTO_LEDS_MS 1500
+#define ORCAMENTO_SONO_MS (PERIODO_AMOSTRA_MS + 500)
+#define ORCAMENTO_LACO_MS (PERIODO_AMOSTRA_MS + 3000)
+#define I2C_TRAVADA_US 500000  // Transação I2C mais longa que isso indica barramento preso
+
+// Ciclo de trabalho: o núcleo dorme entre amostras e o display apaga sem atividade
+#define PERIODO_AMOSTRA_MS 1000  // Intervalo entre amostras
+#define DISPLAY_OCIOSO_MS 30000  // Tempo sem botões pressionados até desligar o display
+
+// Parâmetros da tela: geometria do display escolhida na compilação (SSD1306_LARGURA e
+// SSD1306_ALTURA no CMakeLists.txt, ex.: -DSSD1306_ALTURA=32)
+#ifdef SSD1306_LARGURA
+#define SCREEN_WIDTH SSD1306_LARGURA // Largura da tela
+#define SCREEN_HEIGHT SSD1306_ALTURA // Altura da tela
+#else
+#define SCREEN_WIDTH SSD1306_128X64_LARGURA // Largura da tela
+#define SCREEN_HEIGHT SSD1306_128X64_ALTURA // Altura da tela
+#endif
+
+// Framebuffer estático e primitivas de desenho (oled_*) do display principal
+SSD1306_PAINEL(oled, SCREEN_WIDTH, SCREEN_HEIGHT)
+
+// Barras de qualidade do ar e temperatura (à direita do texto), proporcionais à largura
+// da tela: 18 pixels a partir da coluna 110 no painel de 128 colunas
+#define BARRA_LARGURA_MAX (SCREEN_WIDTH * 9 / 64)
+#define BARRA_X (SCREEN_WIDTH - BARRA_LARGURA_MAX)
+_Static_assert(BARRA_LARGURA_MAX > 0 && BARRA_X < SCREEN_WIDTH, "Barras fora da tela");
+#define TEMPERATURA_MIN 10
+#define TEMPERATURA_MAX 50
+static calibracao_barra_t barra_temperatura;
+static calibracao_barra_t barra_qualidade_ar;
 
 // Variáveis globais
 // Variáveis globais
@@ -52,27 +106,23 @@ static volatile uint32_t last_button_joy_time = 0;  // Controle de debounce do b
 // Variável para armazenar o estado do joystick
 static volatile bool joystick_activated = false;
 
-// Variável para armazenar a quantidade de morcegos
-static volatile int morcegos = 50; 
+// Estado de todos os abrigos (temperatura, qualidade do ar, morcegos e alertas)
+static abrigos_t abrigos;
+static volatile bool simular_abrigos = false;  // Pedido do botão B para novas leituras simuladas
+static volatile int16_t morcegos_pendentes = -1;  // Contagem do botão B aguardando o laço principal (-1 = nenhuma)
+static uint32_t tela_fixa_ate_ms = 0;  // Até quando a tela atual (boas-vindas ou alerta) fica no display
 
 uint32_t get_time_ms(void);
 
-// Definição da variável temperatura
-int temperatura = 0;  // Temperatura inicial como 28°C
 // Variável global para controlar se a temperatura foi fixada
 static volatile bool is_temperature_locked = false;
 
 static volatile bool is_qualidade_ar_locked = false; 
 
-// Definição da variável qualidade do ar
-int qualidade_ar = 50;  // Qualidade inicial do ar (valor médio de 50)
+// Limites da qualidade do ar
 int qualidade_ar_max = 100;  // Máximo de qualidade de ar
 int qualidade_ar_min = 0;    // Mínimo de qualidade de ar
 
-volatile int morcegos_detectados = 0;
-volatile bool alerta_ativo = false;  // Indica se o alerta está ativo
-volatile time_t tempo_inicio = 0;    // Registra o tempo inicial do alerta
-
 // Função para gerar um número aleatório entre 10 e 100
 int gerar_morcegos() {
     return (rand() % 171) + 10; // Gera um número entre 10 e 100
@@ -105,28 +155,9 @@ uint16_t read_adc(uint channel) {
     return adc_read();  // Lê o valor do ADC
 }
 
-// Mapeia os valores do ADC para a tela SSD1306
-int map_adc_to_screen(int adc_value, int center_value, int screen_max) {
-    int range_min = center_value;     // Valor mínimo da faixa de mapeamento
-    int range_max = 4095 - center_value;  // Valor máximo da faixa de mapeamento
-    
-    int offset = adc_value - center_value; // Calcula o deslocamento do valor do ADC
-
-    int mapped_value;
-    if (offset < 0) {
-        mapped_value = ((offset * (screen_max / 2)) / range_min) + (screen_max / 2); // Mapeia valores negativos
-    } else {
-        mapped_value = ((offset * (screen_max / 2)) / range_max) + (screen_max / 2); // Mapeia valores positivos
-    }
-
-    if (mapped_value < 0) mapped_value = 0; // Limita o valor mínimo
-    if (mapped_value > screen_max) mapped_value = screen_max; // Limita o valor máximo
-
-    return mapped_value;
-}
-
 // Função de interrupção para o GPIO
 static void gpio_irq_handler(uint gpio, uint32_t events) {
+    energia_evento();  // Acorda o laço principal e religa o display
     if (gpio == BUTTON_A) {
         uint32_t current_time = time_us_32();
         if (current_time - last_button_a_time > 200000) { // Evita debounce
@@ -138,13 +169,14 @@ static void gpio_irq_handler(uint gpio, uint32_t events) {
         uint32_t current_time = time_us_32();
         if (current_time - last_button_joy_time > 200000) { // Evita debounce
             last_button_joy_time = current_time;
+            calibracao_solicitar();  // Recalibra o joystick quando o botão for solto
             // is_qualidade_ar_locked = !is_qualidade_ar_locked;  // Alterna a fixação da qualidade do ar
         }
     }
     if (gpio == BUTTON_B) {
-        morcegos = gerar_morcegos();
-
-        printf("Botão pressionado! Morcegos atualizados para %d\n", morcegos);
+        // A tabela de abrigos só é alterada no laço principal
+        morcegos_pendentes = gerar_morcegos();
+        simular_abrigos = true;
     }
 }
 
@@ -154,24 +186,31 @@ void update_temperature() {
     gpio_set_dir(BUZZER_PIN, GPIO_OUT);
 
     pwm_buzzer_setup(BUZZER_PIN, BUZZER_FREQUENCY);
+    int temperatura = abrigos.temperatura[ABRIGO_LOCAL];
     uint16_t adc_y = read_adc(0);  // Lê o valor do eixo Y do joystick
 
-    // Calcula o deslocamento do eixo Y
-    int16_t offset_y = adc_y - JOYSTICK_CENTER_Y;
+    // Deslocamento calibrado do eixo Y (zero dentro da zona morta)
+    int8_t offset_y = calibracao_deslocamento(0, adc_y);
 
     // Verifica se o joystick foi movido além da zona morta
-    if (abs(offset_y) > JOYSTICK_DEADZONE) {
+    if (offset_y != 0) {
         joystick_activated = true; // Ativa o joystick quando ele é movido
     }
 
+    // Com o AHT20 presente a temperatura vem do sensor; o joystick só simula na ausência dele
+    if (aht20_presente()) {
+        if (!is_temperature_locked) {
+            temperatura = aht20_temperatura();
+        }
+    }
     // Só altera a temperatura se o joystick foi ativado e a temperatura não estiver fixada
-    if (joystick_activated && !is_temperature_locked) {
+    else if (joystick_activated && !is_temperature_locked) {
         // Se o joystick foi movido para cima (temperatura deve subir)
-        if (offset_y > JOYSTICK_DEADZONE) {
+        if (offset_y > 0) {
             temperatura += 1;  // Aumenta a temperatura lentamente (um grau por vez)
         }
         // Se o joystick foi movido para baixo (temperatura deve diminuir)
-        else if (offset_y < -JOYSTICK_DEADZONE) {
+        else if (offset_y < 0) {
             // Tenta diminuir a temperatura
             if (temperatura > 28) {
                 temperatura -= 1;  // Diminui a temperatura lentamente (um grau por vez)
@@ -179,9 +218,10 @@ void update_temperature() {
         }
 
         // Limita a temperatura dentro dos valores extremos
-        if (temperatura < 10) temperatura = 10; // Garante que a temperatura não seja menor que 10
-        if (temperatura > 50) temperatura = 50; // Limita o valor máximo
+        if (temperatura < TEMPERATURA_MIN) temperatura = TEMPERATURA_MIN; // Garante que a temperatura não seja menor que 10
+        if (temperatura > TEMPERATURA_MAX) temperatura = TEMPERATURA_MAX; // Limita o valor máximo
     }
+    abrigos.temperatura[ABRIGO_LOCAL] = temperatura;
 
     // Lógica para acender os LEDs conforme a temperatura
     // Se a temperatura passar de 38, acende o LED vermelho completamente
@@ -218,22 +258,29 @@ void update_air_quality() {
     gpio_set_dir(BUZZER_PIN, GPIO_OUT);
     pwm_buzzer_setup(BUZZER_PIN, BUZZER_FREQUENCY);
 
+    int qualidade_ar = abrigos.qualidade_ar[ABRIGO_LOCAL];
     uint16_t adc_x = read_adc(1);  // Lê o valor do eixo X do joystick
-    int16_t offset_x = adc_x - JOYSTICK_CENTER_X; // Calcula o deslocamento do eixo X
+    int8_t offset_x = calibracao_deslocamento(1, adc_x); // Deslocamento calibrado do eixo X
 
     // Verifica se o joystick foi movido além da zona morta
-    if (abs(offset_x) > JOYSTICK_DEADZONE) {
+    if (offset_x != 0) {
         joystick_activated = true;  // Ativa o joystick quando ele é movido
     }
 
+    // Com o SGP30 presente a qualidade do ar vem do sensor
+    if (sgp30_presente()) {
+        if (!is_qualidade_ar_locked) {
+            qualidade_ar = sgp30_qualidade_ar();
+        }
+    }
     // Atualiza a qualidade do ar com base no movimento do joystick
-    if (!is_qualidade_ar_locked) {
+    else if (!is_qualidade_ar_locked) {
         // Se o joystick foi movido para a direita (qualidade do ar melhora)
-        if (offset_x > JOYSTICK_DEADZONE) {
+        if (offset_x > 0) {
             qualidade_ar += 10;  // Aumenta a qualidade do ar lentamente
         }
         // Se o joystick foi movido para a esquerda (qualidade do ar piora)
-        else if (offset_x < -JOYSTICK_DEADZONE) {
+        else if (offset_x < 0) {
             if (qualidade_ar > qualidade_ar_min) {
                 qualidade_ar -= 10;  // Diminui a qualidade do ar lentamente
             }
@@ -243,6 +290,7 @@ void update_air_quality() {
         if (qualidade_ar < qualidade_ar_min) qualidade_ar = qualidade_ar_min;
         if (qualidade_ar > qualidade_ar_max) qualidade_ar = qualidade_ar_max;
     }
+    abrigos.qualidade_ar[ABRIGO_LOCAL] = qualidade_ar;
 
     // Lógica para acender LEDs baseados na qualidade do ar
     if (qualidade_ar < 50) {
@@ -260,87 +308,160 @@ void update_air_quality() {
     }
 }
 
-// Função que verifica se os 5 segundos já passaram
-void verificar_tempo_alerta() {
-    if (alerta_ativo && (time(NULL) - tempo_inicio) >= 5) {
-        alerta_ativo = false; // **Desativa o alerta**
-        set_one_led(0, 0, 0, simbolo_perigo); // **Apaga o LED**
-    }
-}
-
-// Função que inicia o alerta de piscar LEDs **somente se necessário**
-void iniciar_alerta_led(int novo_numero) {
-    if (novo_numero > 50 && !alerta_ativo) {  // **Só ativa se o número for maior que 50**
-        alerta_ativo = true;
-        tempo_inicio = time(NULL); // Armazena o tempo de início
-    }
-}
-
-// Atualiza a quantidade de morcegos e gerencia o alerta
-void atualizar_morcegos(int novo_numero) {
-    if (novo_numero != morcegos_detectados) {
-        morcegos_detectados = novo_numero;
-
-        if (novo_numero > 50) {
-            iniciar_alerta_led(novo_numero);  // **Ativa o alerta se necessário**
-        } else {
-            alerta_ativo = false; // **Desativa o alerta se não há perigo**
-            set_one_led(0, 0, 0, simbolo_perigo); // **Apaga o LED imediatamente**
-        }
-    }
-}
-
-// Função para exibir a mensagem de boas-vindas
+// Função para exibir a mensagem de boas-vindas sem bloquear: o quadro segue pela fila I2C
+// e update_display só volta a desenhar depois de SPLASH_MS
 void show_welcome_message(ssd1306_t *ssd) {
     ssd1306_fill(ssd, false);  // Limpa a tela
-    ssd1306_draw_string(ssd, "BEM VINDO", 25, 25);  // Exibe a mensagem de boas-vindas
-    ssd1306_send_data(ssd);  // Atualiza o display
-
-    sleep_ms(5000);  // Espera 5 segundos
-
-    ssd1306_fill(ssd, false);  // Limpa a tela após o tempo de espera
-    ssd1306_send_data(ssd);  // Atualiza o display
+    oled_draw_string(ssd, "BEM VINDO", 25, 25);  // Exibe a mensagem de boas-vindas
+    if (ssd1306_send_data(ssd)) {  // Atualiza o display
+        tela_fixa_ate_ms = to_ms_since_boot(get_absolute_time()) + SPLASH_MS;
+    }
 }
 
-// Função de atualização do display
-void update_display(ssd1306_t *ssd) {
-    ssd1306_fill(ssd, false);  // Limpa a tela
-    
+// Desenha os dados do abrigo local
+static void desenhar_abrigo_local(ssd1306_t *ssd) {
+    int temperatura = abrigos.temperatura[ABRIGO_LOCAL];
+    int qualidade_ar = abrigos.qualidade_ar[ABRIGO_LOCAL];
+
     // Desenha a temperatura na tela
     char temp_str[16];
     snprintf(temp_str, sizeof(temp_str), "TEMP: %d C", temperatura);
-    ssd1306_draw_string(ssd, temp_str, 0, 15);  // Passa o ponteiro correto e remove o 'true'
+    oled_draw_string(ssd, temp_str, 0, 15);  // Passa o ponteiro correto e remove o 'true'
 
     // Desenha a qualidade do ar na tela
     char air_quality_str[16];
     snprintf(air_quality_str, sizeof(air_quality_str), "QUAL AR: %d%%", qualidade_ar);
-    ssd1306_draw_string(ssd, air_quality_str, 0, 0);
+    oled_draw_string(ssd, air_quality_str, 0, 0);
 
     // Desenha uma barra representando a qualidade do ar
-    int air_bar_width = map_adc_to_screen(qualidade_ar, 70, 30); // Mapeia o valor para a largura da tela
-    ssd1306_rect(ssd, 1, 110, air_bar_width, 5, true, true);
-    
-    // Desenha uma barra representando a qualidade do ar
-    int temp_bar_width = map_adc_to_screen(temperatura, 70, 30); // Mapeia o valor para a largura da tela
-    ssd1306_rect(ssd, 15, 110, temp_bar_width, 5, true, true);
+    uint8_t air_bar_width = calibracao_barra(&barra_qualidade_ar, qualidade_ar); // Mapeia o valor para a largura da barra
+    if (air_bar_width > 0) {
+        oled_rect(ssd, 1, BARRA_X, air_bar_width, 5, true, true);
+    }
+
+    // Desenha uma barra representando a temperatura
+    uint8_t temp_bar_width = calibracao_barra(&barra_temperatura, temperatura); // Mapeia o valor para a largura da barra
+    if (temp_bar_width > 0) {
+        oled_rect(ssd, 15, BARRA_X, temp_bar_width, 5, true, true);
+    }
 
-    
     // Atualiza a quantidade de morcegos
     char texto[20];
-    sprintf(texto, "MORCEGOS: %d", morcegos);
-    ssd1306_draw_string(ssd, texto, 0, 30);
+    sprintf(texto, "MORCEGOS: %d", abrigos.morcegos[ABRIGO_LOCAL]);
+    oled_draw_string(ssd, texto, 0, 30);
+}
+
+// Linhas do resumo de abrigos: "07 T45 Q20 M120" no painel de 128 colunas. A última coluna
+// de caracteres fica para a marca de contaminação, e os valores são saturados (T de -9 a 99,
+// Q até 99, M até 999) para a linha nunca quebrar. Em telas estreitas ou com abrigos demais
+// para o índice caber junto, a linha mostra só índice e morcegos.
+#define RESUMO_COLUNAS (SCREEN_WIDTH / 8 - 1)
+#define RESUMO_DIGITOS (ABRIGOS_QUANTIDADE > 1000 ? 4 : ABRIGOS_QUANTIDADE > 100 ? 3 : 2)
+#define RESUMO_COMPLETO (RESUMO_DIGITOS + 13 <= RESUMO_COLUNAS)  // " T45 Q99 M999"
+_Static_assert(RESUMO_DIGITOS + 5 <= RESUMO_COLUNAS, "Resumo de abrigos nao cabe na tela");  // " M999"
+
+// Desenha uma página da lista dos piores abrigos: número, temperatura, ar e morcegos
+static void desenhar_resumo_abrigos(ssd1306_t *ssd, uint pagina) {
+    const uint linhas = SCREEN_HEIGHT / 8 - 1;  // Primeira linha é o cabeçalho
+    uint16_t piores[ABRIGOS_MAX];
+    uint16_t n = abrigos_piores(&abrigos, piores, MIN((pagina + 1) * linhas, abrigos.quantidade));  // Só até esta página
+
+    // Cabeçalho usa a linha inteira; sem espaço para o texto, só os números
+    char cabecalho[SCREEN_WIDTH / 8 + 1];
+    if (snprintf(cabecalho, sizeof(cabecalho), "ALERTA %u DE %u", abrigos.afetados,
+                 abrigos.quantidade) >= (int)sizeof(cabecalho)) {
+        snprintf(cabecalho, sizeof(cabecalho), "%u DE %u", abrigos.afetados,
+                 abrigos.quantidade);
+    }
+    oled_draw_string(ssd, cabecalho, 0, 0);
+
+    char texto[RESUMO_COLUNAS + 1];
+    for (uint l = 0; l < linhas; l++) {
+        uint pos = pagina * linhas + l;
+        if (pos >= n) break;
+        uint16_t i = piores[pos];
+        int temperatura = MAX(-9, MIN(99, abrigos.temperatura[i]));
+        uint morcegos = MIN(999, abrigos.morcegos[i]);
+        if (RESUMO_COMPLETO) {
+            snprintf(texto, sizeof(texto), "%0*u T%d Q%u M%u", RESUMO_DIGITOS, i, temperatura,
+                     MIN(99, abrigos.qualidade_ar[i]), morcegos);
+        } else {
+            snprintf(texto, sizeof(texto), "%0*u M%u", RESUMO_DIGITOS, i, morcegos);
+        }
+        oled_draw_string(ssd, texto, 0, (l + 1) * 8);
+        if (abrigos.contaminacao[i]) {
+            oled_rect(ssd, (l + 1) * 8, SCREEN_WIDTH - 4, 3, 7, true, true);  // Marca de contaminação
+        }
+    }
+}
 
-    ssd1306_send_data(ssd);  // **Atualiza o display primeiro!**
+// Função de atualização do display
+void update_display(ssd1306_t *ssd) {
+    // Página 0 mostra o abrigo local; as seguintes, o resumo dos piores abrigos
+    static uint pagina = 0;
+    static uint32_t pagina_desde = 0;
+    const uint linhas = SCREEN_HEIGHT / 8 - 1;
+    uint paginas = abrigos.quantidade > 1 ? 1 + (abrigos.quantidade + linhas - 1) / linhas : 1;
+
+    uint32_t agora = to_ms_since_boot(get_absolute_time());
+    if (agora - pagina_desde >= PAGINA_MS) {
+        pagina = (pagina + 1) % paginas;
+        pagina_desde = agora;
+    }
 
-    // Atualiza a contagem de morcegos e ativa/desativa o alerta
-    atualizar_morcegos(morcegos);
+    // Quadro anterior ainda na fila I2C: não redesenha o buffer para evitar cortes na imagem
+    // Display desligado pelo gerenciador de energia ou boas-vindas/alerta na tela: nada a desenhar
+    if (ssd1306_ocupado(ssd) || !energia_display_ligado() || agora < tela_fixa_ate_ms) {
+        return;
+    }
 
+    ssd1306_fill(ssd, false);  // Limpa a tela
+    if (pagina == 0) {
+        desenhar_abrigo_local(ssd);
+    } else {
+        desenhar_resumo_abrigos(ssd, pagina - 1);
+    }
+    ssd1306_send_data(ssd);
+}
+
+// Mostra na matriz de LEDs os abrigos de maior risco, do pior para o melhor:
+// vermelho contaminado, amarelo em alerta, verde normal
+void update_led_matriz() {
+    if (abrigos.quantidade == 1) {
+        // Abrigo único: pisca o símbolo de perigo durante o alerta de população
+        if (abrigos.alerta[ABRIGO_LOCAL]) {
+            set_one_led(50, 0, 0, simbolo_perigo);
+            sleep_ms(500);
+            set_one_led(0, 0, 0, simbolo_perigo);
+            sleep_ms(500);
+        }
+        return;
+    }
+
+    uint32_t cores[LED_CONTAGEM] = { 0 };
+    uint16_t piores[LED_CONTAGEM];
+    uint16_t n = abrigos_piores(&abrigos, piores, LED_CONTAGEM);
+    for (uint led = 0; led < n; led++) {
+        uint16_t i = piores[led];
+        if (abrigos.contaminacao[i]) {
+            cores[led] = cor_led(50, 0, 0);
+        } else if (abrigos.alerta[i]) {
+            cores[led] = cor_led(30, 20, 0);
+        } else {
+            cores[led] = cor_led(0, 5, 0);
+        }
+    }
+    set_leds_cores(cores);
 }
 
 // Função para exibir o alerta no display
 void show_alert(ssd1306_t *ssd) {
+    // Quadro anterior ainda na fila I2C: o alerta fica para a próxima iteração, como em update_display
+    if (ssd1306_ocupado(ssd)) {
+        return;
+    }
     ssd1306_fill(ssd, false); // Limpa o display
-    ssd1306_draw_string(ssd, "CONTAMINACAO", 0, 0);
+    oled_draw_string(ssd, "CONTAMINACAO", 0, 0);
     
     pwm_set_gpio_level(LED_RED, 65535);
     gpio_put(LED_GREEN, 0);
@@ -351,47 +472,78 @@ void show_alert(ssd1306_t *ssd) {
     pwm_set_gpio_level(BUZZER_PIN, 0);
     
     char alerta[64];
-    snprintf(alerta, sizeof(alerta), "TEMP: %dC", temperatura);
-    ssd1306_draw_string(ssd, alerta, 0, 15);
+    snprintf(alerta, sizeof(alerta), "TEMP: %dC", abrigos.temperatura[ABRIGO_LOCAL]);
+    oled_draw_string(ssd, alerta, 0, 15);
     
-    snprintf(alerta, sizeof(alerta), "QUAL AR: %d", qualidade_ar);
-    ssd1306_draw_string(ssd, alerta, 0, 30);
+    snprintf(alerta, sizeof(alerta), "QUAL AR: %d", abrigos.qualidade_ar[ABRIGO_LOCAL]);
+    oled_draw_string(ssd, alerta, 0, 30);
     
-    snprintf(alerta, sizeof(alerta), "MORCEGOS: %d", morcegos);
-    ssd1306_draw_string(ssd, alerta, 0, 45);
+    snprintf(alerta, sizeof(alerta), "MORCEGOS: %d", abrigos.morcegos[ABRIGO_LOCAL]);
+    oled_draw_string(ssd, alerta, 0, 45);
     
-    ssd1306_send_data(ssd);
-    sleep_ms(5000);
-    ssd1306_fill(ssd, false); // Limpa o display ao sair do alerta
-    ssd1306_send_data(ssd);
+    // A tela fica fixa sem bloquear o laço; depois update_display volta a desenhar.
+    // Quadro descartado pela fila: o alerta é repetido na próxima iteração
+    if (ssd1306_send_data(ssd)) {
+        tela_fixa_ate_ms = to_ms_since_boot(get_absolute_time()) + ALERTA_TELA_MS;
+    }
 }
 
 // Função para verificar condição de alerta
 void check_alert_conditions(ssd1306_t *ssd) {
-    if (temperatura > 40 && qualidade_ar < 70 && morcegos > 50) {
+    // Repete o alerta quando a tela anterior expira, como antes fazia a espera de 5 s
+    uint32_t agora = to_ms_since_boot(get_absolute_time());
+    if (abrigos.contaminacao[ABRIGO_LOCAL] && agora >= tela_fixa_ate_ms) {
+        energia_manter_ativo();  // O alerta precisa do display ligado
         show_alert(ssd);
     }
 }
 
 
+// Marco da primeira amostra: instante da primeira leitura válida de um sensor, registrado
+// pelo próprio driver. Sem sensores na placa, vale a primeira amostra simulada pelo joystick.
+static void marcar_primeira_amostra(void) {
+    uint64_t aht20 = aht20_primeira_leitura();
+    uint64_t sgp30 = sgp30_primeira_leitura();
+    if (aht20 || sgp30) {
+        inicializacao_marcar_em(INIC_PRIMEIRA_AMOSTRA, aht20 && sgp30 ? MIN(aht20, sgp30) : aht20 | sgp30);
+    } else if (time_us_64() > INIC_ESPERA_SENSORES_US) {
+        inicializacao_marcar(INIC_PRIMEIRA_AMOSTRA);
+    }
+}
+
 int main() {
     stdio_init_all();  // Inicializa a comunicação padrão
-    // Variáveis e configurações PIO
-    PIO pio = pio0;
-    int sm = 0;
-    uint offset = pio_add_program(pio, &ws2812_program);  // Adiciona o programa para controlar a matriz de LEDs
-    ws2812_program_init(pio, sm, offset, MATRIZ_LED_PIN, 800000, false);  // Inicializa a matriz de LEDs
-    
-    
-    gpio_init(BUZZER_PIN);
-    gpio_set_dir(BUZZER_PIN, GPIO_OUT);
+    abrigos_init(&abrigos, ABRIGOS_QUANTIDADE);
+    abrigos_simular(&abrigos, ABRIGO_LOCAL + 1);  // Abrigos remotos ainda sem enlace: leituras simuladas
 
-    pwm_setup(LED_RED);  // Configura o PWM para o LED vermelho
-    pwm_setup(LED_BLUE); // Configura o PWM para o LED azul
+    // Periféricos na ordem em que a amostragem precisa deles: ADC, barramento I2C
+    // (sensores e display), botões e, por último, as saídas de alerta
 
-    gpio_init(LED_GREEN); // Inicializa o LED verde
-    gpio_set_dir(LED_GREEN, GPIO_OUT);
-    gpio_put(LED_GREEN, 0);  // Inicializa o LED verde apagado
+    adc_init();  // Inicializa o ADC
+    adc_gpio_init(JOYSTICK_X_PIN);  // Inicializa o pino do eixo X do joystick
+    adc_gpio_init(JOYSTICK_Y_PIN);  // Inicializa o pino do eixo Y do joystick
+    calibracao_init();  // Carrega a calibração da flash ou mede com o joystick em repouso
+    calibracao_barra_init(&barra_qualidade_ar, qualidade_ar_min, qualidade_ar_max, BARRA_LARGURA_MAX);
+    calibracao_barra_init(&barra_temperatura, TEMPERATURA_MIN, TEMPERATURA_MAX, BARRA_LARGURA_MAX);
+
+    i2c_init(I2C_PORT, 400 * 1000);  // Inicializa a comunicação I2C
+    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);  // Configura os pinos SDA e SCL para I2C
+    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
+    gpio_pull_up(I2C_SDA);
+    gpio_pull_up(I2C_SCL);
+
+    // O barramento é compartilhado pela fila: display e sensores sem bloqueio
+    i2c_fila_init(I2C_PORT);
+    aht20_iniciar(AHT20_PERIODO_MS);
+    sgp30_iniciar();
+
+    ssd1306_t ssd;  // Declaração da estrutura do display SSD1306
+    oled_init(&ssd, false, SSD1306_ADDR, I2C_PORT);  // Inicializa o display SSD1306
+    ssd1306_usar_fila(&ssd);
+    if (!ssd1306_config(&ssd)) {  // Configura o display (sequência de comandos enfileirada)
+        printf("Display: fila I2C cheia, configuracao nao enviada\n");
+    }
+    show_welcome_message(&ssd);  // Boas-vindas sem bloquear a amostragem
 
     gpio_init(BUTTON_A);  // Inicializa o botão A
     gpio_set_dir(BUTTON_A, GPIO_IN);
@@ -403,48 +555,97 @@ int main() {
     gpio_pull_up(BUTTON_B); // Ativa pull-up interno
     gpio_set_irq_enabled_with_callback(BUTTON_B, GPIO_IRQ_EDGE_FALL, true, &gpio_irq_handler);
 
-
-
     gpio_init(BUTTON_JOY); // Inicializa o botão do joystick
     gpio_set_dir(BUTTON_JOY, GPIO_IN);
     gpio_pull_up(BUTTON_JOY);  // Habilita o pull-up para o botão do joystick
     gpio_set_irq_enabled(BUTTON_JOY, GPIO_IRQ_EDGE_FALL, true);  // Configura a interrupção para o botão do joystick
 
-    adc_init();  // Inicializa o ADC
-    adc_gpio_init(JOYSTICK_X_PIN);  // Inicializa o pino do eixo X do joystick
-    adc_gpio_init(JOYSTICK_Y_PIN);  // Inicializa o pino do eixo Y do joystick
+    gpio_init(BUZZER_PIN);
+    gpio_set_dir(BUZZER_PIN, GPIO_OUT);
 
-    i2c_init(I2C_PORT, 400 * 1000);  // Inicializa a comunicação I2C
-    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);  // Configura os pinos SDA e SCL para I2C
-    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C_SDA);
-    gpio_pull_up(I2C_SCL);
+    pwm_setup(LED_RED);  // Configura o PWM para o LED vermelho
+    pwm_setup(LED_BLUE); // Configura o PWM para o LED azul
 
-    ssd1306_t ssd;  // Declaração da estrutura do display SSD1306
-    ssd1306_init(&ssd, 128, 64, false, SSD1306_ADDR, I2C_PORT);  // Inicializa o display SSD1306
-    ssd1306_config(&ssd);  // Configura o display
-    ssd1306_send_data(&ssd);  // Envia os dados de configuração para o display
-    ssd1306_fill(&ssd, false);  // Limpa a tela
+    gpio_init(LED_GREEN); // Inicializa o LED verde
+    gpio_set_dir(LED_GREEN, GPIO_OUT);
+    gpio_put(LED_GREEN, 0);  // Inicializa o LED verde apagado
 
-    // Exibe a mensagem de boas-vindas por 5 segundos
-    show_welcome_message(&ssd);
+    // Variáveis e configurações PIO
+    PIO pio = pio0;
+    int sm = 0;
+    uint offset = pio_add_program(pio, &ws2812_program);  // Adiciona o programa para controlar a matriz de LEDs
+    ws2812_program_init(pio, sm, offset, MATRIZ_LED_PIN, 800000, false);  // Inicializa a matriz de LEDs
+
+    energia_init(&ssd, PERIODO_AMOSTRA_MS, DISPLAY_OCIOSO_MS);
+    inicializacao_marcar(INIC_PERIFERICOS);
+
+    // Watchdog por último: relata a causa do último reset e só então começa a contar
+    vigia_registrar(ETAPA_AMOSTRAGEM, "amostragem", ORCAMENTO_AMOSTRAGEM_MS);
+    vigia_registrar(ETAPA_ALERTAS, "alertas", ORCAMENTO_ALERTAS_MS);
+    vigia_registrar(ETAPA_DISPLAY, "display", ORCAMENTO_DISPLAY_MS);
+    vigia_registrar(ETAPA_LEDS, "leds", ORCAMENTO_LEDS_MS);
+    vigia_registrar(ETAPA_SONO, "sono", ORCAMENTO_SONO_MS);
+    vigia_registrar(ETAPA_I2C, "i2c", 0);
+    vigia_init(ORCAMENTO_LACO_MS);
 
     while (1) {
+        vigia_laco_inicio();
+
+        vigia_etapa_inicio(ETAPA_AMOSTRAGEM);
+        // Recalibração pedida pelo botão do joystick, medida depois de ele ser solto
+        calibracao_atualizar(!gpio_get(BUTTON_JOY), to_ms_since_boot(get_absolute_time()));
+
         update_temperature();      // Atualiza a temperatura
         update_air_quality();
+        marcar_primeira_amostra();
+
+        // Contagem de morcegos pedida pelo botão B
+        uint32_t estado = save_and_disable_interrupts();
+        int morcegos = morcegos_pendentes;
+        morcegos_pendentes = -1;
+        restore_interrupts(estado);
+        if (morcegos >= 0) {
+            abrigos_registrar(&abrigos, ABRIGO_LOCAL, abrigos.temperatura[ABRIGO_LOCAL],
+                              abrigos.qualidade_ar[ABRIGO_LOCAL], morcegos);
+            printf("Botão pressionado! Morcegos atualizados para %d\n", morcegos);
+        }
+        if (simular_abrigos) {
+            simular_abrigos = false;
+            abrigos_simular(&abrigos, ABRIGO_LOCAL + 1);
+        }
+        vigia_etapa_fim(ETAPA_AMOSTRAGEM);
+
+        // Avalia alertas de todos os abrigos de uma vez
+        vigia_etapa_inicio(ETAPA_ALERTAS);
+        abrigos_avaliar(&abrigos, to_ms_since_boot(get_absolute_time()));
         check_alert_conditions(&ssd);
+        vigia_etapa_fim(ETAPA_ALERTAS);
 
-        update_display(&ssd);    // Atualiza a qualidade do ar
-        sleep_ms(100);             // Delay para o próximo ciclo
-        if (alerta_ativo) {
-            set_one_led(50, 0, 0, simbolo_perigo); 
-            sleep_ms(500);
-            set_one_led(0, 0, 0, simbolo_perigo);
-            sleep_ms(500);
+        vigia_etapa_inicio(ETAPA_DISPLAY);
+        update_display(&ssd);
+        vigia_etapa_fim(ETAPA_DISPLAY);
+
+        vigia_etapa_inicio(ETAPA_LEDS);
+        update_led_matriz();
+        vigia_etapa_fim(ETAPA_LEDS);
+
+        // Barramento preso não impede o laço (a fila é assíncrona), então é verificado à parte
+        if (!i2c_fila_travada(I2C_TRAVADA_US)) {
+            vigia_checkin(ETAPA_I2C);
+        }
+
+        uint64_t ultimo_quadro = ssd1306_ultimo_quadro(&ssd);
+        if (ultimo_quadro) {
+            inicializacao_marcar_em(INIC_PRIMEIRO_QUADRO, ultimo_quadro);
         }
+        inicializacao_relatar();
+
+        energia_relatar_periodicamente();
+        vigia_etapa_inicio(ETAPA_SONO);
+        energia_dormir();          // Dorme até a próxima amostra ou um botão ser pressionado
+        vigia_etapa_fim(ETAPA_SONO);
 
-        verificar_tempo_alerta(); // **Garante que o alerta pare após 5 segundos**
-        
+        vigia_laco_fim();          // Alimenta o watchdog só se todas as etapas fizeram check-in
     }
 
     return 0;
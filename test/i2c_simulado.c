@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <string.h>
+#include "i2c_simulado.h"
+#include "sdk_simulado.h"
+#include "hardware/i2c.h"
+
+#define I2C_SIM_DISPOSITIVOS 8
+#define I2C_SIM_ESCRITA 64
+#define I2C_SIM_LIMITE_IRQ 100000  // Tratador chamado mais do que isso: interrupção presa
+
+i2c_sim_registro_t i2c_sim;
+
+static struct {
+  const i2c_dispositivo_t *dispositivos[I2C_SIM_DISPOSITIVOS];
+  const i2c_dispositivo_t *atual;  // Dispositivo endereçado (NULL = sem resposta)
+  uint32_t tx_limiar;
+  uint32_t mascara;
+
+  uint32_t tx[I2C_SIM_FIFO];
+  uint32_t tx_nivel;
+  uint8_t rx[I2C_SIM_FIFO];
+  uint32_t rx_nivel;
+
+  bool abrt, stop;          // Interrupções travadas até serem limpas
+  bool stop_pendente;       // STOP gerado pelo controlador depois do abort
+  bool descartando;         // Abort: FIFO descartada até o próximo endereçamento
+  uint8_t escrita[I2C_SIM_ESCRITA];
+  uint16_t escrita_len;
+  uint16_t leitura_pos;
+} sim;
+
+void i2c_simulado_reiniciar(void) {
+  memset(&sim, 0, sizeof(sim));
+  memset(&i2c_sim, 0, sizeof(i2c_sim));
+}
+
+void i2c_simulado_conectar(const i2c_dispositivo_t *dispositivo) {
+  for (int i = 0; i < I2C_SIM_DISPOSITIVOS; i++) {
+    if (!sim.dispositivos[i]) {
+      sim.dispositivos[i] = dispositivo;
+      return;
+    }
+  }
+}
+
+void i2c_simulado_desconectar(uint8_t endereco) {
+  for (int i = 0; i < I2C_SIM_DISPOSITIVOS; i++) {
+    if (sim.dispositivos[i] && sim.dispositivos[i]->endereco == endereco)
+      sim.dispositivos[i] = NULL;
+  }
+}
+
+uint32_t i2c_simulado_mascara(void) {
+  return sim.mascara;
+}
+
+static void entregar_escrita(void) {
+  if (sim.escrita_len && sim.atual && sim.atual->escrita)
+    sim.atual->escrita(sim.escrita, sim.escrita_len);
+  sim.escrita_len = 0;
+}
+
+// Executa um comando da FIFO de TX no barramento
+static void processar_comando(uint32_t cmd) {
+  if (sim.descartando)
+    return;
+  if (!sim.atual) {
+    // Endereço sem ACK: abort, FIFO descartada e STOP em seguida
+    sim.abrt = true;
+    sim.stop_pendente = true;
+    sim.descartando = true;
+    i2c_sim.abortou = true;
+    return;
+  }
+
+  if (cmd & I2C_IC_DATA_CMD_CMD_BITS) {
+    entregar_escrita();  // RESTART: a escrita anterior termina aqui
+    if (sim.rx_nivel >= I2C_SIM_FIFO) {
+      i2c_sim.estouros_fifo++;
+    } else {
+      sim.rx[sim.rx_nivel++] = sim.atual->leitura ? sim.atual->leitura(sim.leitura_pos) : 0xFF;
+    }
+    sim.leitura_pos++;
+  } else if (sim.escrita_len < I2C_SIM_ESCRITA) {
+    sim.escrita[sim.escrita_len++] = (uint8_t)cmd;
+  }
+
+  if (cmd & I2C_IC_DATA_CMD_STOP_BITS) {
+    entregar_escrita();
+    sim.stop = true;
+  }
+}
+
+void i2c_simulado_executar(void) {
+  for (uint32_t n = 0; n < I2C_SIM_LIMITE_IRQ; n++) {
+    for (uint32_t i = 0; i < sim.tx_nivel; i++)
+      processar_comando(sim.tx[i]);
+    sim.tx_nivel = 0;
+
+    uint32_t bruto = (sim.abrt ? I2C_IC_INTR_STAT_R_TX_ABRT_BITS : 0) |
+                     (sim.stop ? I2C_IC_INTR_STAT_R_STOP_DET_BITS : 0) |
+                     (sim.rx_nivel > 0 ? I2C_IC_INTR_STAT_R_RX_FULL_BITS : 0) |
+                     (sim.tx_nivel <= sim.tx_limiar ? I2C_IC_INTR_STAT_R_TX_EMPTY_BITS : 0);
+    uint32_t status = bruto & sim.mascara;
+    if (!status || !sim_irq_i2c)
+      return;
+
+    bool abrt = status & I2C_IC_INTR_STAT_R_TX_ABRT_BITS;
+    i2c_sim.interrupcoes++;
+    sim_irq_i2c();
+    if (abrt)
+      i2c_sim.mascara_apos_abort = sim.mascara;
+
+    // O STOP após um abort chega depois que o tratador já viu o TX_ABRT
+    if (sim.stop_pendente && !sim.abrt) {
+      sim.stop_pendente = false;
+      sim.stop = true;
+    }
+  }
+  fprintf(stderr, "i2c_simulado: interrupcao presa\n");
+}
+
+// Registradores vistos por i2c_fila.c
+
+void i2c_hw_configurar(i2c_inst_t *i2c, uint32_t tx_limiar) {
+  (void)i2c;
+  sim.tx_limiar = tx_limiar;
+  sim.mascara = 0;
+}
+
+void i2c_hw_alvo(i2c_inst_t *i2c, uint8_t endereco) {
+  (void)i2c;
+  sim.atual = NULL;
+  for (int i = 0; i < I2C_SIM_DISPOSITIVOS; i++) {
+    if (sim.dispositivos[i] && sim.dispositivos[i]->endereco == endereco)
+      sim.atual = sim.dispositivos[i];
+  }
+  sim.descartando = false;
+  sim.escrita_len = 0;
+  sim.leitura_pos = 0;
+  if (i2c_sim.transacoes < I2C_SIM_LOG)
+    i2c_sim.alvos[i2c_sim.transacoes] = endereco;
+  i2c_sim.transacoes++;
+}
+
+uint32_t i2c_hw_tx_nivel(i2c_inst_t *i2c) {
+  (void)i2c;
+  return sim.tx_nivel;
+}
+
+uint32_t i2c_hw_rx_nivel(i2c_inst_t *i2c) {
+  (void)i2c;
+  return sim.rx_nivel;
+}
+
+void i2c_hw_comando(i2c_inst_t *i2c, uint32_t cmd) {
+  (void)i2c;
+  if (sim.tx_nivel >= I2C_SIM_FIFO) {
+    i2c_sim.estouros_fifo++;
+    return;
+  }
+  sim.tx[sim.tx_nivel++] = cmd;
+}
+
+uint8_t i2c_hw_dado(i2c_inst_t *i2c) {
+  (void)i2c;
+  if (sim.rx_nivel == 0)
+    return 0;
+  uint8_t byte = sim.rx[0];
+  memmove(sim.rx, sim.rx + 1, --sim.rx_nivel);
+  return byte;
+}
+
+uint32_t i2c_hw_status(i2c_inst_t *i2c) {
+  (void)i2c;
+  return ((sim.abrt ? I2C_IC_INTR_STAT_R_TX_ABRT_BITS : 0) |
+          (sim.stop ? I2C_IC_INTR_STAT_R_STOP_DET_BITS : 0) |
+          (sim.rx_nivel > 0 ? I2C_IC_INTR_STAT_R_RX_FULL_BITS : 0) |
+          (sim.tx_nivel <= sim.tx_limiar ? I2C_IC_INTR_STAT_R_TX_EMPTY_BITS : 0)) & sim.mascara;
+}
+
+void i2c_hw_limpar(i2c_inst_t *i2c, uint32_t status) {
+  (void)i2c;
+  if (status & I2C_IC_INTR_STAT_R_TX_ABRT_BITS)
+    sim.abrt = false;
+  if (status & I2C_IC_INTR_STAT_R_STOP_DET_BITS)
+    sim.stop = false;
+}
+
+void i2c_hw_mascara(i2c_inst_t *i2c, uint32_t mascara) {
+  (void)i2c;
+  sim.mascara = mascara;
+}
@@ -0,0 +1,38 @@
+#ifndef I2C_SIMULADO_H
+#define I2C_SIMULADO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Controlador I2C simulado para i2c_fila.c (compilado com I2C_FILA_CONTROLADOR_SIMULADO).
+// Os comandos ficam na FIFO de TX até i2c_simulado_executar, que os entrega aos dispositivos
+// conectados, levanta as interrupções como o controlador do RP2040 e chama o tratador da fila
+// até o barramento ficar ocioso. Endereços sem dispositivo geram TX_ABRT seguido de STOP_DET.
+
+#define I2C_SIM_FIFO 16
+#define I2C_SIM_LOG 128
+
+typedef struct {
+  uint8_t endereco;
+  void (*escrita)(const uint8_t *dados, uint16_t len);  // Bytes escritos antes do STOP/RESTART
+  uint8_t (*leitura)(uint16_t pos);                     // Byte 'pos' da fase de leitura
+} i2c_dispositivo_t;
+
+typedef struct {
+  uint8_t alvos[I2C_SIM_LOG];      // Endereço de cada transação iniciada, em ordem
+  uint16_t transacoes;
+  uint32_t interrupcoes;           // Chamadas ao tratador
+  uint32_t estouros_fifo;          // Comandos além da profundidade das FIFOs (deve ficar em 0)
+  bool abortou;
+  uint32_t mascara_apos_abort;     // intr_mask deixada pelo tratador que recebeu TX_ABRT
+} i2c_sim_registro_t;
+
+extern i2c_sim_registro_t i2c_sim;
+
+void i2c_simulado_reiniciar(void);
+void i2c_simulado_conectar(const i2c_dispositivo_t *dispositivo);
+void i2c_simulado_desconectar(uint8_t endereco);
+void i2c_simulado_executar(void);
+uint32_t i2c_simulado_mascara(void);
+
+#endif // I2C_SIMULADO_H
@@ -0,0 +1,10 @@
+#ifndef SDK_SIMULADO_HARDWARE_ADC_H
+#define SDK_SIMULADO_HARDWARE_ADC_H
+
+#include "pico/stdlib.h"
+
+// Cada leitura consulta sim_adc (ver sdk_simulado.h) com o canal selecionado
+void adc_select_input(uint input);
+uint16_t adc_read(void);
+
+#endif // SDK_SIMULADO_HARDWARE_ADC_H
@@ -0,0 +1,18 @@
+#ifndef SDK_SIMULADO_HARDWARE_FLASH_H
+#define SDK_SIMULADO_HARDWARE_FLASH_H
+
+#include <stdint.h>
+#include "pico/stdlib.h"
+
+// Flash simulada de dois setores em memória, mapeada em XIP_BASE como na placa
+#define FLASH_PAGE_SIZE 256u
+#define FLASH_SECTOR_SIZE 4096u
+#define PICO_FLASH_SIZE_BYTES (2 * FLASH_SECTOR_SIZE)
+
+extern uint8_t sim_flash[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uintptr_t)sim_flash)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#endif // SDK_SIMULADO_HARDWARE_FLASH_H
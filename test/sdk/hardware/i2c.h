@@ -0,0 +1,31 @@
+#ifndef SDK_SIMULADO_HARDWARE_I2C_H
+#define SDK_SIMULADO_HARDWARE_I2C_H
+
+#include "pico/stdlib.h"
+
+// Só os tipos e bits usados pela fila; os registradores em si ficam no controlador simulado
+typedef struct i2c_inst i2c_inst_t;
+extern i2c_inst_t i2c0_inst, i2c1_inst;
+#define i2c0 (&i2c0_inst)
+#define i2c1 (&i2c1_inst)
+
+#define I2C0_IRQ 23
+static inline uint i2c_hw_index(i2c_inst_t *i2c) { return i2c == i2c1 ? 1 : 0; }
+
+#define I2C_IC_DATA_CMD_RESTART_BITS 0x00000400u
+#define I2C_IC_DATA_CMD_STOP_BITS 0x00000200u
+#define I2C_IC_DATA_CMD_CMD_BITS 0x00000100u
+
+#define I2C_IC_INTR_MASK_M_STOP_DET_BITS 0x00000200u
+#define I2C_IC_INTR_MASK_M_TX_ABRT_BITS 0x00000040u
+#define I2C_IC_INTR_MASK_M_TX_EMPTY_BITS 0x00000010u
+#define I2C_IC_INTR_MASK_M_RX_FULL_BITS 0x00000004u
+
+#define I2C_IC_INTR_STAT_R_STOP_DET_BITS 0x00000200u
+#define I2C_IC_INTR_STAT_R_TX_ABRT_BITS 0x00000040u
+#define I2C_IC_INTR_STAT_R_TX_EMPTY_BITS 0x00000010u
+#define I2C_IC_INTR_STAT_R_RX_FULL_BITS 0x00000004u
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+#endif // SDK_SIMULADO_HARDWARE_I2C_H
@@ -0,0 +1,12 @@
+#ifndef SDK_SIMULADO_HARDWARE_IRQ_H
+#define SDK_SIMULADO_HARDWARE_IRQ_H
+
+#include <stdbool.h>
+#include "pico/stdlib.h"
+
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+
+#endif // SDK_SIMULADO_HARDWARE_IRQ_H
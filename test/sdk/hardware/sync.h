@@ -0,0 +1,12 @@
+#ifndef SDK_SIMULADO_HARDWARE_SYNC_H
+#define SDK_SIMULADO_HARDWARE_SYNC_H
+
+#include <stdint.h>
+
+// No host não há interrupções concorrentes: os "ISRs" só rodam dentro de sim_avancar_us e
+// __wfi. O simulador conta as seções críticas para os testes conferirem o mascaramento.
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+void __wfi(void);  // Avança o relógio até o próximo alarme e o dispara
+
+#endif // SDK_SIMULADO_HARDWARE_SYNC_H
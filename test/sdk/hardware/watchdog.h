@@ -0,0 +1,19 @@
+#ifndef SDK_SIMULADO_HARDWARE_WATCHDOG_H
+#define SDK_SIMULADO_HARDWARE_WATCHDOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+  uint32_t scratch[8];  // Preservados entre "resets" simulados
+} watchdog_hw_t;
+
+extern watchdog_hw_t sim_watchdog;
+#define watchdog_hw (&sim_watchdog)
+
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug);
+void watchdog_update(void);
+bool watchdog_caused_reboot(void);
+bool watchdog_enable_caused_reboot(void);
+
+#endif // SDK_SIMULADO_HARDWARE_WATCHDOG_H
@@ -0,0 +1,260 @@
+#include <stdio.h>
+#include <string.h>
+#include "sdk_simulado.h"
+#include "hardware/adc.h"
+#include "hardware/flash.h"
+#include "hardware/i2c.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
+
+#define SIM_ALARMES 32
+
+struct i2c_inst {
+  int indice;
+};
+i2c_inst_t i2c0_inst = { 0 }, i2c1_inst = { 1 };
+
+typedef struct {
+  alarm_id_t id;             // 0 = livre
+  uint64_t alvo_us;
+  alarm_callback_t callback;
+  void *ctx;
+  repeating_timer_t *timer;  // Não nulo para timers repetitivos
+} sim_alarme_t;
+
+static uint64_t agora_us;
+static sim_alarme_t alarmes[SIM_ALARMES];
+static alarm_id_t proximo_id = 1;
+
+uint32_t sim_latencia_wfi_us;
+void (*sim_apos_alarme)(void);
+irq_handler_t sim_irq_i2c;
+uint32_t sim_secoes_criticas;
+
+uint16_t (*sim_adc)(uint canal);
+uint32_t sim_flash_gravacoes;
+uint8_t sim_flash[PICO_FLASH_SIZE_BYTES];
+static uint canal_adc;
+
+watchdog_hw_t sim_watchdog;
+uint32_t sim_watchdog_alimentacoes;
+uint32_t sim_watchdog_timeout_ms;
+bool sim_watchdog_reset;
+
+void sim_reiniciar(void) {
+  agora_us = 0;
+  memset(alarmes, 0, sizeof(alarmes));
+  proximo_id = 1;
+  sim_latencia_wfi_us = 0;
+  sim_apos_alarme = NULL;
+  sim_irq_i2c = NULL;
+  sim_secoes_criticas = 0;
+  sim_adc = NULL;
+  sim_flash_gravacoes = 0;
+  sim_watchdog_alimentacoes = 0;
+  sim_watchdog_timeout_ms = 0;
+}
+
+uint64_t time_us_64(void) {
+  return agora_us;
+}
+
+uint32_t time_us_32(void) {
+  return (uint32_t)agora_us;
+}
+
+absolute_time_t get_absolute_time(void) {
+  return agora_us;
+}
+
+void sleep_us(uint64_t us) {
+  sim_avancar_us(us);
+}
+
+static alarm_id_t agendar(uint64_t alvo_us, alarm_callback_t callback, void *ctx, repeating_timer_t *timer) {
+  for (int i = 0; i < SIM_ALARMES; i++) {
+    if (alarmes[i].id == 0) {
+      alarmes[i] = (sim_alarme_t){ proximo_id++, alvo_us, callback, ctx, timer };
+      return alarmes[i].id;
+    }
+  }
+  fprintf(stderr, "sdk_simulado: alarmes esgotados\n");
+  return -1;
+}
+
+static void disparar(sim_alarme_t *a) {
+  sim_alarme_t alarme = *a;
+  a->id = 0;
+
+  if (alarme.timer) {
+    if (alarme.timer->callback(alarme.timer)) {
+      alarme.timer->alarm_id = agendar(alarme.alvo_us + alarme.timer->delay_us, NULL, NULL, alarme.timer);
+    }
+  } else {
+    // Mesma convenção do SDK: <0 reagenda a partir do alvo anterior, >0 a partir de agora
+    int64_t r = alarme.callback(alarme.id, alarme.ctx);
+    if (r < 0)
+      agendar(alarme.alvo_us - r, alarme.callback, alarme.ctx, NULL);
+    else if (r > 0)
+      agendar(agora_us + r, alarme.callback, alarme.ctx, NULL);
+  }
+
+  if (sim_apos_alarme)
+    sim_apos_alarme();
+}
+
+// Alarme ativo de menor alvo (empates na ordem de criação)
+static sim_alarme_t *proximo_alarme(void) {
+  sim_alarme_t *proximo = NULL;
+  for (int i = 0; i < SIM_ALARMES; i++) {
+    sim_alarme_t *a = &alarmes[i];
+    if (a->id && (!proximo || a->alvo_us < proximo->alvo_us ||
+                  (a->alvo_us == proximo->alvo_us && a->id < proximo->id)))
+      proximo = a;
+  }
+  return proximo;
+}
+
+void sim_avancar_us(uint64_t us) {
+  uint64_t fim = agora_us + us;
+  sim_alarme_t *a;
+  while ((a = proximo_alarme()) && a->alvo_us <= fim) {
+    if (a->alvo_us > agora_us)
+      agora_us = a->alvo_us;
+    disparar(a);
+  }
+  agora_us = fim;
+}
+
+void sim_avancar_mascarado_us(uint64_t us) {
+  agora_us += us;
+}
+
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+  if (time <= agora_us) {
+    if (!fire_if_past)
+      return 0;
+    int64_t r = callback(0, user_data);
+    if (r == 0)
+      return 0;
+    return agendar(r < 0 ? time - r : agora_us + r, callback, user_data, NULL);
+  }
+  return agendar(time, callback, user_data, NULL);
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+  return add_alarm_at(agora_us + us, callback, user_data, fire_if_past);
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+  return add_alarm_at(agora_us + (uint64_t)ms * 1000, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t alarm_id) {
+  for (int i = 0; i < SIM_ALARMES; i++) {
+    if (alarm_id > 0 && alarmes[i].id == alarm_id) {
+      alarmes[i].id = 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data,
+                            repeating_timer_t *out) {
+  int64_t periodo = delay_us < 0 ? -delay_us : delay_us;
+  out->delay_us = periodo;
+  out->callback = callback;
+  out->user_data = user_data;
+  out->alarm_id = agendar(agora_us + periodo, NULL, NULL, out);
+  return out->alarm_id > 0;
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data,
+                            repeating_timer_t *out) {
+  return add_repeating_timer_us((int64_t)delay_ms * 1000, callback, user_data, out);
+}
+
+bool cancel_repeating_timer(repeating_timer_t *timer) {
+  for (int i = 0; i < SIM_ALARMES; i++) {
+    if (alarmes[i].id && alarmes[i].timer == timer) {
+      alarmes[i].id = 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t save_and_disable_interrupts(void) {
+  sim_secoes_criticas++;
+  return 0;
+}
+
+void restore_interrupts(uint32_t status) {
+  (void)status;
+}
+
+// O núcleo dorme até o próximo alarme; sem alarmes pendentes retorna de imediato
+void __wfi(void) {
+  sim_alarme_t *a = proximo_alarme();
+  if (!a)
+    return;
+  if (a->alvo_us > agora_us)
+    agora_us = a->alvo_us;
+  disparar(a);
+  agora_us += sim_latencia_wfi_us;
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+  if (num == I2C0_IRQ || num == I2C0_IRQ + 1)
+    sim_irq_i2c = handler;
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+  (void)num;
+  (void)enabled;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+  (void)i2c;
+  (void)addr;
+  (void)src;
+  (void)nostop;
+  return (int)len;
+}
+
+void adc_select_input(uint input) {
+  canal_adc = input;
+}
+
+uint16_t adc_read(void) {
+  return sim_adc ? sim_adc(canal_adc) : 2048;
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+  memset(&sim_flash[flash_offs], 0xFF, count);
+}
+
+// Como na flash real, a programação só leva bits de 1 para 0
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+  for (size_t i = 0; i < count; i++)
+    sim_flash[flash_offs + i] &= data[i];
+  sim_flash_gravacoes++;
+}
+
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug) {
+  (void)pause_on_debug;
+  sim_watchdog_timeout_ms = delay_ms;
+}
+
+void watchdog_update(void) {
+  sim_watchdog_alimentacoes++;
+}
+
+bool watchdog_caused_reboot(void) {
+  return sim_watchdog_reset;
+}
+
+bool watchdog_enable_caused_reboot(void) {
+  return sim_watchdog_reset;
+}
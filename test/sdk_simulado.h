@@ -0,0 +1,33 @@
+#ifndef SDK_SIMULADO_H
+#define SDK_SIMULADO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "hardware/irq.h"
+
+// Controle do SDK simulado: relógio virtual, alarmes, interrupção I2C, ADC, flash e watchdog.
+// Alarmes e timers repetitivos só disparam dentro de sim_avancar_us e __wfi, no instante
+// exato em que vencem, de modo que os testes reproduzem a mesma sequência em toda execução.
+
+void sim_reiniciar(void);             // Relógio em zero, sem alarmes; scratch do watchdog e flash preservados
+void sim_avancar_us(uint64_t us);     // Avança o relógio disparando os alarmes vencidos
+static inline void sim_avancar_ms(uint32_t ms) { sim_avancar_us((uint64_t)ms * 1000); }
+void sim_avancar_mascarado_us(uint64_t us);  // Como com interrupções mascaradas: os alarmes vencidos
+                                             // disparam no próximo sim_avancar_us ou __wfi
+
+extern uint32_t sim_latencia_wfi_us;      // Atraso entre o alarme e a volta do __wfi
+extern void (*sim_apos_alarme)(void);     // Chamado após cada alarme (ex.: executar o I2C simulado)
+extern irq_handler_t sim_irq_i2c;         // Tratador registrado para a interrupção I2C
+extern uint32_t sim_secoes_criticas;      // Chamadas a save_and_disable_interrupts
+
+// ADC e flash
+extern uint16_t (*sim_adc)(uint canal);   // Leitura do canal no instante atual (nulo = 2048)
+extern uint32_t sim_flash_gravacoes;      // Chamadas a flash_range_program
+
+// Watchdog
+extern uint32_t sim_watchdog_alimentacoes;
+extern uint32_t sim_watchdog_timeout_ms;  // 0 = desabilitado
+extern bool sim_watchdog_reset;           // Próxima inicialização vem de um reset pelo watchdog
+
+#endif // SDK_SIMULADO_H
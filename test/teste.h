@@ -0,0 +1,39 @@
+#ifndef TESTE_H
+#define TESTE_H
+
+#include <stdio.h>
+
+// Verificações dos testes no host: cada falha é impressa e o programa termina com código 1
+
+static int teste_falhas;
+
+#define VERIFICA(cond)                                                      \
+  do {                                                                      \
+    if (!(cond)) {                                                          \
+      printf("%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond);             \
+      teste_falhas++;                                                       \
+    }                                                                       \
+  } while (0)
+
+#define VERIFICA_IGUAL(obtido, esperado)                                    \
+  do {                                                                      \
+    long long obtido_ = (long long)(obtido), esperado_ = (long long)(esperado); \
+    if (obtido_ != esperado_) {                                             \
+      printf("%s:%d: falhou: %s == %lld (esperado %lld)\n", __FILE__, __LINE__, \
+             #obtido, obtido_, esperado_);                                  \
+      teste_falhas++;                                                       \
+    }                                                                       \
+  } while (0)
+
+#define TESTE(funcao)                \
+  do {                               \
+    printf("-- %s\n", #funcao);      \
+    funcao();                        \
+  } while (0)
+
+static inline int teste_resultado(void) {
+  printf(teste_falhas ? "%d falha(s)\n" : "ok\n", teste_falhas);
+  return teste_falhas ? 1 : 0;
+}
+
+#endif // TESTE_H
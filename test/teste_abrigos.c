@@ -0,0 +1,154 @@
+// Tabela de abrigos em escala (compilada com -DABRIGOS_MAX=4096): custo por abrigo da
+// avaliação e da seleção dos piores, memória por abrigo, ordem dos piores e expiração de alertas
+#include <stdlib.h>
+#include <time.h>
+#include "teste.h"
+#include "abrigos.h"
+
+#define REPETICOES 200
+#define K_PIORES 8
+
+static abrigos_t abrigos;
+
+static double agora_ns(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+// Leituras reproduzíveis em todas as execuções
+static void preencher(uint32_t semente) {
+  srand(semente);
+  abrigos_init(&abrigos, ABRIGOS_MAX);
+  abrigos_simular(&abrigos, 0);
+}
+
+static int comparar_risco(const void *a, const void *b) {
+  uint16_t ra = abrigos.risco[*(const uint16_t *)a];
+  uint16_t rb = abrigos.risco[*(const uint16_t *)b];
+  return (int)rb - (int)ra;
+}
+
+static void teste_escala(void) {
+  preencher(1);
+  VERIFICA_IGUAL(abrigos.quantidade, ABRIGOS_MAX);
+
+  double inicio = agora_ns();
+  for (int r = 0; r < REPETICOES; r++)
+    abrigos_avaliar(&abrigos, 1000 + r);
+  double avaliar_ns = (agora_ns() - inicio) / REPETICOES;
+
+  uint16_t piores[K_PIORES];
+  uint16_t n = 0;
+  inicio = agora_ns();
+  for (int r = 0; r < REPETICOES; r++)
+    n = abrigos_piores(&abrigos, piores, K_PIORES);
+  double piores_ns = (agora_ns() - inicio) / REPETICOES;
+  VERIFICA_IGUAL(n, K_PIORES);
+
+  size_t bytes = sizeof(abrigos_t) / ABRIGOS_MAX;
+  printf("%d abrigos: %zu bytes por abrigo (tabela de %zu bytes)\n", ABRIGOS_MAX, bytes, sizeof(abrigos_t));
+  printf("abrigos_avaliar: %.0f ns (%.2f ns por abrigo)\n", avaliar_ns, avaliar_ns / ABRIGOS_MAX);
+  printf("abrigos_piores(k=%d): %.0f ns (%.2f ns por abrigo)\n", K_PIORES, piores_ns, piores_ns / ABRIGOS_MAX);
+  VERIFICA_IGUAL(bytes, ABRIGO_BYTES);
+}
+
+// A seleção parcial devolve os mesmos riscos, na mesma ordem, que a ordenação completa
+static void teste_ordem_piores(void) {
+  static uint16_t ordenados[ABRIGOS_MAX];
+  static uint16_t piores[ABRIGOS_MAX];
+
+  for (uint32_t semente = 1; semente <= 5; semente++) {
+    preencher(semente);
+    abrigos_avaliar(&abrigos, 0);
+    for (uint16_t i = 0; i < ABRIGOS_MAX; i++)
+      ordenados[i] = i;
+    qsort(ordenados, ABRIGOS_MAX, sizeof(ordenados[0]), comparar_risco);
+
+    const uint16_t ks[] = { 1, 7, 25, 100 };
+    for (unsigned j = 0; j < sizeof(ks) / sizeof(ks[0]); j++) {
+      uint16_t k = ks[j];
+      VERIFICA_IGUAL(abrigos_piores(&abrigos, piores, k), k);
+      static uint8_t visto[ABRIGOS_MAX];
+      for (uint16_t i = 0; i < k; i++) {
+        VERIFICA_IGUAL(abrigos.risco[piores[i]], abrigos.risco[ordenados[i]]);
+        VERIFICA(!visto[piores[i]]);
+        visto[piores[i]] = 1;
+      }
+      for (uint16_t i = 0; i < k; i++)
+        visto[piores[i]] = 0;
+    }
+  }
+
+  // k maior que a tabela devolve só os abrigos existentes
+  abrigos_init(&abrigos, 3);
+  abrigos_avaliar(&abrigos, 0);
+  VERIFICA_IGUAL(abrigos_piores(&abrigos, piores, 10), 3);
+  VERIFICA_IGUAL(abrigos_piores(&abrigos, piores, 0), 0);
+}
+
+// Alerta de população: liga quando a contagem muda para acima do limiar, dura
+// ABRIGO_ALERTA_DURACAO_MS e desliga de imediato se a contagem cair
+static void teste_alertas(void) {
+  abrigos_init(&abrigos, ABRIGOS_MAX);
+  abrigos_avaliar(&abrigos, 0);
+  VERIFICA_IGUAL(abrigos.em_alerta, 0);
+
+  for (uint16_t i = 0; i < ABRIGOS_MAX; i += 4)
+    abrigos_registrar(&abrigos, i, 30, 80, 120);
+  abrigos_avaliar(&abrigos, 1000);
+  VERIFICA_IGUAL(abrigos.em_alerta, ABRIGOS_MAX / 4);
+  VERIFICA_IGUAL(abrigos.afetados, ABRIGOS_MAX / 4);
+  VERIFICA(abrigos.alerta[0] && !abrigos.alerta[1]);
+
+  // Contagem diferente ainda acima do limiar não reinicia a contagem do alerta
+  abrigos_registrar(&abrigos, 4, 30, 80, 130);
+  abrigos_avaliar(&abrigos, 1000 + ABRIGO_ALERTA_DURACAO_MS - 1);
+  VERIFICA_IGUAL(abrigos.em_alerta, ABRIGOS_MAX / 4);
+
+  // Queda abaixo do limiar desliga de imediato
+  abrigos_registrar(&abrigos, 8, 30, 80, 20);
+  abrigos_avaliar(&abrigos, 1000 + ABRIGO_ALERTA_DURACAO_MS - 1);
+  VERIFICA(!abrigos.alerta[8]);
+  VERIFICA_IGUAL(abrigos.em_alerta, ABRIGOS_MAX / 4 - 1);
+
+  // Expiração
+  abrigos_avaliar(&abrigos, 1000 + ABRIGO_ALERTA_DURACAO_MS);
+  VERIFICA_IGUAL(abrigos.em_alerta, 0);
+
+  // Nova mudança de contagem depois da expiração dispara outro alerta
+  abrigos_registrar(&abrigos, 0, 30, 80, 121);
+  abrigos_avaliar(&abrigos, 20000);
+  VERIFICA(abrigos.alerta[0]);
+  VERIFICA_IGUAL(abrigos.em_alerta, 1);
+  abrigos_avaliar(&abrigos, 20000 + ABRIGO_ALERTA_DURACAO_MS);
+  VERIFICA_IGUAL(abrigos.em_alerta, 0);
+
+  // Contaminação exige calor, ar ruim e população, e domina o risco
+  abrigos_registrar(&abrigos, 5, 45, 40, 100);
+  abrigos_registrar(&abrigos, 6, 45, 80, 100);
+  abrigos_avaliar(&abrigos, 30000);
+  VERIFICA_IGUAL(abrigos.contaminados, 1);
+  VERIFICA(abrigos.contaminacao[5] && !abrigos.contaminacao[6]);
+  uint16_t pior;
+  abrigos_piores(&abrigos, &pior, 1);
+  VERIFICA_IGUAL(pior, 5);
+
+  // O abrigo contaminado também está em alerta (mais de 50 morcegos): conta uma vez
+  VERIFICA(abrigos.alerta[5] && abrigos.alerta[6]);
+  VERIFICA_IGUAL(abrigos.em_alerta, 2);
+  VERIFICA_IGUAL(abrigos.afetados, 2);
+
+  // Alerta expirado, contaminação continua
+  abrigos_avaliar(&abrigos, 30000 + ABRIGO_ALERTA_DURACAO_MS);
+  VERIFICA_IGUAL(abrigos.em_alerta, 0);
+  VERIFICA_IGUAL(abrigos.contaminados, 1);
+  VERIFICA_IGUAL(abrigos.afetados, 1);
+}
+
+int main(void) {
+  TESTE(teste_escala);
+  TESTE(teste_ordem_piores);
+  TESTE(teste_alertas);
+  return teste_resultado();
+}
@@ -0,0 +1,99 @@
+// Calibração do joystick: espera o botão ser solto, rejeita manche desviado ou em movimento
+// e grava na flash apenas centros aceitos
+#include "teste.h"
+#include "sdk_simulado.h"
+#include "calibracao.h"
+
+// Joystick simulado: posição de cada eixo mais um ruído alternado de ±ruido
+static uint16_t posicao[CALIB_CANAIS];
+static uint16_t ruido;
+static uint32_t leituras;
+
+static uint16_t joystick(uint canal) {
+  leituras++;
+  return posicao[canal] + ((leituras & 1) ? ruido : -ruido);
+}
+
+static void joystick_em(uint16_t x, uint16_t y, uint16_t r) {
+  posicao[0] = x;
+  posicao[1] = y;
+  ruido = r;
+}
+
+static void preparar(void) {
+  sim_reiniciar();
+  sim_adc = joystick;
+  joystick_em(2000, 2100, 5);
+}
+
+static void teste_medicao_e_flash(void) {
+  preparar();
+  calibracao_init();  // Flash vazia: mede e grava
+  VERIFICA_IGUAL(sim_flash_gravacoes, 1);
+  VERIFICA_IGUAL(calibracao_centro(0), 2000);
+  VERIFICA_IGUAL(calibracao_centro(1), 2100);
+  VERIFICA_IGUAL(calibracao_deslocamento(0, 2000), 0);
+  VERIFICA(calibracao_deslocamento(0, 4095) >= 99);  // Ponto médio da última faixa da tabela
+  VERIFICA(calibracao_deslocamento(0, 0) <= -99);
+
+  // Próxima inicialização carrega da flash sem medir
+  preparar();
+  joystick_em(2500, 2500, 5);
+  calibracao_init();
+  VERIFICA_IGUAL(sim_flash_gravacoes, 0);
+  VERIFICA_IGUAL(calibracao_centro(0), 2000);
+}
+
+// Manche segurado em um canto: leitura estável, mas longe do meio da escala
+static void teste_centro_desviado(void) {
+  preparar();
+  joystick_em(2048 + CALIB_CENTRO_DESVIO_MAX + 100, 2048, 5);
+  VERIFICA(!calibracao_medir());
+  joystick_em(2048, 2048 - CALIB_CENTRO_DESVIO_MAX - 100, 5);
+  VERIFICA(!calibracao_medir());
+  VERIFICA_IGUAL(sim_flash_gravacoes, 0);
+  VERIFICA_IGUAL(calibracao_centro(0), 2000);  // Calibração anterior mantida
+
+  // Em movimento
+  joystick_em(2048, 2048, CALIB_RUIDO_MAX);
+  VERIFICA(!calibracao_medir());
+  VERIFICA_IGUAL(sim_flash_gravacoes, 0);
+}
+
+// O pedido vem do botão do joystick: nada é medido enquanto ele está pressionado nem antes
+// de CALIB_ASSENTAMENTO_MS com ele solto
+static void teste_espera_botao(void) {
+  preparar();
+  joystick_em(2048 + CALIB_CENTRO_DESVIO_MAX + 100, 2048, 5);  // Dedo ainda no manche
+  calibracao_solicitar();
+  VERIFICA(!calibracao_atualizar(true, 0));
+  VERIFICA(!calibracao_atualizar(true, 2000));
+  VERIFICA(calibracao_pendente());
+
+  joystick_em(2060, 2030, 5);  // Solto
+  VERIFICA(!calibracao_atualizar(false, 3000));
+  VERIFICA(!calibracao_atualizar(false, 3000 + CALIB_ASSENTAMENTO_MS - 1));
+
+  // Pressionado de novo: a espera recomeça
+  VERIFICA(!calibracao_atualizar(true, 3600));
+  VERIFICA(!calibracao_atualizar(false, 3700));
+  VERIFICA(!calibracao_atualizar(false, 3700 + CALIB_ASSENTAMENTO_MS - 1));
+  VERIFICA_IGUAL(sim_flash_gravacoes, 0);
+
+  VERIFICA(calibracao_atualizar(false, 3700 + CALIB_ASSENTAMENTO_MS));
+  VERIFICA(!calibracao_pendente());
+  VERIFICA_IGUAL(sim_flash_gravacoes, 1);
+  VERIFICA_IGUAL(calibracao_centro(0), 2060);
+  VERIFICA_IGUAL(calibracao_centro(1), 2030);
+
+  // Sem pedido não mede
+  VERIFICA(!calibracao_atualizar(false, 10000));
+  VERIFICA_IGUAL(sim_flash_gravacoes, 1);
+}
+
+int main(void) {
+  TESTE(teste_medicao_e_flash);
+  TESTE(teste_centro_desviado);
+  TESTE(teste_espera_botao);
+  return teste_resultado();
+}
@@ -0,0 +1,189 @@
+// Gerenciador de energia em tempo virtual: ciclo de trabalho, recuperação de atraso,
+// latência de despertar, interrupções no sono e desligamento do display por ociosidade
+#include "teste.h"
+#include "sdk_simulado.h"
+#include "energia.h"
+
+#define PERIODO_MS 1000
+#define OCIOSO_MS 30000
+
+// O display só recebe comandos de liga/desliga do gerenciador
+static ssd1306_t ssd;
+static int comandos_display;
+static uint8_t ultimo_comando;
+static bool fila_cheia;  // Comandos recusados como pela fila I2C sem espaço
+
+bool ssd1306_command(ssd1306_t *ssd, uint8_t command) {
+  (void)ssd;
+  if (fila_cheia)
+    return false;
+  comandos_display++;
+  ultimo_comando = command;
+  return true;
+}
+
+static void preparar(void) {
+  sim_reiniciar();
+  comandos_display = 0;
+  fila_cheia = false;
+  energia_init(&ssd, PERIODO_MS, OCIOSO_MS);
+}
+
+static int64_t botao(alarm_id_t id, void *ctx) {
+  energia_evento();  // Como no tratador de GPIO
+  return 0;
+}
+
+// 50 ms de trabalho por período de 1 s: 5% acordado, despertares no ritmo das amostras
+static void teste_ciclo_de_trabalho(void) {
+  preparar();
+  for (int i = 0; i < 10; i++) {
+    sim_avancar_ms(50);
+    energia_dormir();
+    VERIFICA_IGUAL(time_us_64(), (uint64_t)(i + 1) * PERIODO_MS * 1000);
+  }
+
+  energia_estatisticas_t e;
+  energia_estatisticas(&e);
+  VERIFICA_IGUAL(e.total_us, 10 * PERIODO_MS * 1000);
+  VERIFICA_IGUAL(e.acordado_us, 10 * 50 * 1000);
+  VERIFICA_IGUAL(e.dormindo_us, 10 * (PERIODO_MS - 50) * 1000);
+  VERIFICA_IGUAL(e.despertares, 10);
+  VERIFICA_IGUAL(e.interrupcoes_no_sono, 0);
+  VERIFICA_IGUAL(e.latencia_max_us, 0);
+  VERIFICA_IGUAL(e.proxima_amostra_us, 11 * PERIODO_MS * 1000);
+  VERIFICA_IGUAL(e.display_us, e.total_us);
+  VERIFICA_IGUAL(comandos_display, 0);
+}
+
+// Processamento mais longo que o período: sem dormir e sem acumular amostras atrasadas
+static void teste_recuperacao_atraso(void) {
+  preparar();
+  energia_estatisticas_t e;
+
+  // Atraso menor que um período: mantém a fase (próxima em 2 s)
+  sim_avancar_ms(1500);
+  energia_dormir();
+  energia_estatisticas(&e);
+  VERIFICA_IGUAL(time_us_64(), 1500000);
+  VERIFICA_IGUAL(e.dormindo_us, 0);
+  VERIFICA_IGUAL(e.proxima_amostra_us, 2000000);
+
+  energia_dormir();
+  VERIFICA_IGUAL(time_us_64(), 2000000);
+
+  // Atraso de mais de um período: reagenda a partir de agora
+  sim_avancar_ms(2500);
+  energia_dormir();
+  energia_estatisticas(&e);
+  VERIFICA_IGUAL(time_us_64(), 4500000);
+  VERIFICA_IGUAL(e.proxima_amostra_us, 5500000);
+
+  energia_dormir();
+  energia_estatisticas(&e);
+  VERIFICA_IGUAL(time_us_64(), 5500000);
+  VERIFICA_IGUAL(e.proxima_amostra_us, 6500000);
+  VERIFICA_IGUAL(e.dormindo_us, 500000 + 1000000);
+  VERIFICA_IGUAL(e.despertares, 4);
+}
+
+// Um botão no meio do sono acorda o núcleo; a latência é medida até a volta do WFI
+static void teste_latencia(void) {
+  preparar();
+  sim_latencia_wfi_us = 35;
+  add_alarm_in_ms(300, botao, NULL, true);
+
+  energia_dormir();
+  energia_estatisticas_t e;
+  energia_estatisticas(&e);
+  VERIFICA_IGUAL(time_us_64(), 300035);
+  VERIFICA_IGUAL(e.latencia_max_us, 35);
+  VERIFICA_IGUAL(e.proxima_amostra_us, PERIODO_MS * 1000);  // O evento não adia a amostra
+
+  energia_dormir();
+  energia_estatisticas(&e);
+  VERIFICA_IGUAL(time_us_64(), PERIODO_MS * 1000 + 35);
+  VERIFICA_IGUAL(e.latencia_max_us, 35);  // Despertar pelo alarme da amostra não conta
+  VERIFICA_IGUAL(e.despertares, 2);
+}
+
+static bool timer_alheio(repeating_timer_t *timer) {
+  return true;
+}
+
+// Timer de outro módulo interrompe o sono sem encerrá-lo: cada interrupção é contada à parte
+// dos despertares do laço
+static void teste_interrupcoes_no_sono(void) {
+  preparar();
+  repeating_timer_t timer;
+  add_repeating_timer_ms(300, timer_alheio, NULL, &timer);
+
+  energia_dormir();
+  energia_estatisticas_t e;
+  energia_estatisticas(&e);
+  VERIFICA_IGUAL(time_us_64(), PERIODO_MS * 1000);  // Só a amostra encerra o sono
+  VERIFICA_IGUAL(e.despertares, 1);
+  VERIFICA_IGUAL(e.interrupcoes_no_sono, 3);
+  cancel_repeating_timer(&timer);
+}
+
+// Sem atividade o display apaga após OCIOSO_MS e volta no próximo evento
+static void teste_display_ocioso(void) {
+  preparar();
+  while (time_us_64() < (uint64_t)OCIOSO_MS * 1000)
+    energia_dormir();
+  VERIFICA(energia_display_ligado());
+
+  energia_dormir();
+  VERIFICA(!energia_display_ligado());
+  VERIFICA_IGUAL(comandos_display, 1);
+  VERIFICA_IGUAL(ultimo_comando, SET_DISP | 0x00);
+
+  add_alarm_in_ms(5500, botao, NULL, true);
+  for (int i = 0; i < 5; i++)
+    energia_dormir();
+  VERIFICA(!energia_display_ligado());
+  energia_dormir();  // Acorda pelo botão
+  VERIFICA(energia_display_ligado());
+  VERIFICA_IGUAL(ultimo_comando, SET_DISP | 0x01);
+
+  energia_estatisticas_t e;
+  energia_estatisticas(&e);
+  VERIFICA_IGUAL(e.display_us, (uint64_t)OCIOSO_MS * 1000);
+}
+
+// Comando de liga/desliga recusado pela fila: o estado não muda e o comando é repetido
+static void teste_display_fila_cheia(void) {
+  preparar();
+  fila_cheia = true;
+  while (time_us_64() <= (uint64_t)OCIOSO_MS * 1000)
+    energia_dormir();
+  VERIFICA(energia_display_ligado());  // Não desligou de fato: continua contando como ligado
+  VERIFICA_IGUAL(comandos_display, 0);
+
+  fila_cheia = false;
+  energia_dormir();
+  VERIFICA(!energia_display_ligado());
+  VERIFICA_IGUAL(ultimo_comando, SET_DISP | 0x00);
+
+  // Botão com a fila cheia: religa no próximo ciclo
+  fila_cheia = true;
+  add_alarm_in_ms(300, botao, NULL, true);
+  energia_dormir();
+  VERIFICA(!energia_display_ligado());
+  fila_cheia = false;
+  energia_dormir();
+  VERIFICA(energia_display_ligado());
+  VERIFICA_IGUAL(ultimo_comando, SET_DISP | 0x01);
+  VERIFICA_IGUAL(comandos_display, 2);
+}
+
+int main(void) {
+  TESTE(teste_ciclo_de_trabalho);
+  TESTE(teste_recuperacao_atraso);
+  TESTE(teste_latencia);
+  TESTE(teste_interrupcoes_no_sono);
+  TESTE(teste_display_ocioso);
+  TESTE(teste_display_fila_cheia);
+  return teste_resultado();
+}
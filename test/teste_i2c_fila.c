@@ -0,0 +1,220 @@
+// Fila I2C contra o controlador simulado: prioridade, anel, FIFOs e abort
+#include <string.h>
+#include "teste.h"
+#include "sdk_simulado.h"
+#include "i2c_simulado.h"
+#include "i2c_fila.h"
+
+#define ADDR_A 0x10
+#define ADDR_B 0x20
+#define ADDR_C 0x30
+#define ADDR_AUSENTE 0x50
+
+static uint8_t recebido[64];
+static uint16_t recebido_len;
+static uint16_t escritas;
+
+static void guardar_escrita(const uint8_t *dados, uint16_t len) {
+  memcpy(recebido, dados, len);
+  recebido_len = len;
+  escritas++;
+}
+
+static uint8_t contador(uint16_t pos) {
+  return (uint8_t)(0xA0 + pos);
+}
+
+static const i2c_dispositivo_t dispositivo_a = { ADDR_A, guardar_escrita, contador };
+static const i2c_dispositivo_t dispositivo_b = { ADDR_B, guardar_escrita, contador };
+static const i2c_dispositivo_t dispositivo_c = { ADDR_C, guardar_escrita, contador };
+
+// Ordem de conclusão registrada pelos callbacks (ctx = identificador da transação)
+static int concluidas[128];
+static bool resultados[128];
+static int n_concluidas;
+
+static void registrar(bool ok, void *ctx) {
+  resultados[n_concluidas] = ok;
+  concluidas[n_concluidas++] = (int)(intptr_t)ctx;
+}
+
+static void preparar(void) {
+  sim_reiniciar();
+  i2c_simulado_reiniciar();
+  i2c_simulado_conectar(&dispositivo_a);
+  i2c_simulado_conectar(&dispositivo_b);
+  i2c_simulado_conectar(&dispositivo_c);
+  i2c_fila_init(i2c1);
+  n_concluidas = 0;
+  escritas = 0;
+  recebido_len = 0;
+}
+
+static bool escrever(uint8_t endereco, int id, i2c_prioridade_t prioridade) {
+  const uint8_t dados[] = { (uint8_t)id };
+  return i2c_fila_escrever(endereco, dados, 1, prioridade, registrar, (void *)(intptr_t)id);
+}
+
+// Transações de alta prioridade passam na frente das de baixa já enfileiradas
+static void teste_prioridade(void) {
+  preparar();
+  VERIFICA(escrever(ADDR_A, 0, I2C_PRIORIDADE_BAIXA));  // Começa de imediato
+  VERIFICA(escrever(ADDR_B, 1, I2C_PRIORIDADE_BAIXA));
+  VERIFICA(escrever(ADDR_B, 2, I2C_PRIORIDADE_BAIXA));
+  VERIFICA(escrever(ADDR_C, 3, I2C_PRIORIDADE_ALTA));
+  VERIFICA(!i2c_fila_ociosa());
+
+  i2c_simulado_executar();
+
+  VERIFICA(i2c_fila_ociosa());
+  VERIFICA_IGUAL(n_concluidas, 4);
+  const int ordem[] = { 0, 3, 1, 2 };
+  const uint8_t alvos[] = { ADDR_A, ADDR_C, ADDR_B, ADDR_B };
+  for (int i = 0; i < 4; i++) {
+    VERIFICA_IGUAL(concluidas[i], ordem[i]);
+    VERIFICA(resultados[i]);
+    VERIFICA_IGUAL(i2c_sim.alvos[i], alvos[i]);
+  }
+  VERIFICA_IGUAL(i2c_fila_erros(), 0);
+}
+
+// Anel cheio recusa a transação; depois de esvaziado, o anel dá a volta mantendo a ordem
+static void teste_anel(void) {
+  preparar();
+  VERIFICA(escrever(ADDR_A, 0, I2C_PRIORIDADE_ALTA));  // Ocupa o barramento
+  for (int i = 1; i <= I2C_FILA_CAPACIDADE; i++)
+    VERIFICA(escrever(ADDR_B, i, I2C_PRIORIDADE_BAIXA));
+  VERIFICA_IGUAL(i2c_fila_livres(I2C_PRIORIDADE_BAIXA), 0);
+  VERIFICA(!escrever(ADDR_B, 99, I2C_PRIORIDADE_BAIXA));
+  VERIFICA_IGUAL(i2c_fila_livres(I2C_PRIORIDADE_ALTA), I2C_FILA_CAPACIDADE);
+
+  i2c_simulado_executar();
+  VERIFICA_IGUAL(n_concluidas, I2C_FILA_CAPACIDADE + 1);
+  for (int i = 0; i <= I2C_FILA_CAPACIDADE; i++)
+    VERIFICA_IGUAL(concluidas[i], i);
+  VERIFICA_IGUAL(i2c_fila_livres(I2C_PRIORIDADE_BAIXA), I2C_FILA_CAPACIDADE);
+
+  // Segunda volta com o início do anel no meio do vetor
+  for (int i = 0; i < 23; i++)
+    VERIFICA(escrever(ADDR_B, i, I2C_PRIORIDADE_BAIXA));
+  i2c_simulado_executar();
+  n_concluidas = 0;
+  VERIFICA(escrever(ADDR_A, 0, I2C_PRIORIDADE_ALTA));
+  for (int i = 1; i <= I2C_FILA_CAPACIDADE; i++)
+    VERIFICA(escrever(ADDR_B, i, I2C_PRIORIDADE_BAIXA));
+  VERIFICA(!escrever(ADDR_B, 99, I2C_PRIORIDADE_BAIXA));
+  i2c_simulado_executar();
+  VERIFICA_IGUAL(n_concluidas, I2C_FILA_CAPACIDADE + 1);
+  for (int i = 0; i <= I2C_FILA_CAPACIDADE; i++)
+    VERIFICA_IGUAL(concluidas[i], i);
+}
+
+// Escrita maior que a FIFO é realimentada por TX_EMPTY sem estourar os 16 níveis
+static void teste_escrita_longa(void) {
+  preparar();
+  uint8_t bloco[33];
+  for (int i = 0; i < 33; i++)
+    bloco[i] = (uint8_t)(i * 7);
+  i2c_transacao_t t = {
+    .endereco = ADDR_A,
+    .tx_curto = { 0x40 },
+    .tx_curto_len = 1,
+    .tx = bloco,
+    .tx_len = sizeof(bloco),
+    .callback = registrar,
+  };
+  VERIFICA(i2c_fila_enviar(&t, I2C_PRIORIDADE_BAIXA));
+  i2c_simulado_executar();
+
+  VERIFICA_IGUAL(n_concluidas, 1);
+  VERIFICA(resultados[0]);
+  VERIFICA_IGUAL(escritas, 1);
+  VERIFICA_IGUAL(recebido_len, 34);
+  VERIFICA_IGUAL(recebido[0], 0x40);
+  VERIFICA(memcmp(&recebido[1], bloco, sizeof(bloco)) == 0);
+  VERIFICA_IGUAL(i2c_sim.estouros_fifo, 0);
+}
+
+// Comando seguido de leitura com RESTART, maior que a FIFO de recepção
+static void teste_leitura(void) {
+  preparar();
+  uint8_t rx[24];
+  memset(rx, 0, sizeof(rx));
+  i2c_transacao_t t = {
+    .endereco = ADDR_C,
+    .tx_curto = { 0xE1 },
+    .tx_curto_len = 1,
+    .rx = rx,
+    .rx_len = sizeof(rx),
+    .callback = registrar,
+  };
+  VERIFICA(i2c_fila_enviar(&t, I2C_PRIORIDADE_ALTA));
+  i2c_simulado_executar();
+
+  VERIFICA_IGUAL(n_concluidas, 1);
+  VERIFICA(resultados[0]);
+  VERIFICA_IGUAL(recebido_len, 1);
+  VERIFICA_IGUAL(recebido[0], 0xE1);
+  for (int i = 0; i < (int)sizeof(rx); i++)
+    VERIFICA_IGUAL(rx[i], contador(i));
+  VERIFICA_IGUAL(i2c_sim.estouros_fifo, 0);
+}
+
+// Dispositivo ausente: falha reportada, TX_EMPTY desligado no abort e a fila segue
+static void teste_abort(void) {
+  preparar();
+  static uint8_t bloco[40];
+  i2c_transacao_t t = {
+    .endereco = ADDR_AUSENTE,
+    .tx_curto = { 0x40 },
+    .tx_curto_len = 1,
+    .tx = bloco,
+    .tx_len = sizeof(bloco),
+    .callback = registrar,
+    .ctx = (void *)1,
+  };
+  VERIFICA(i2c_fila_enviar(&t, I2C_PRIORIDADE_BAIXA));
+  VERIFICA(i2c_simulado_mascara() & I2C_IC_INTR_MASK_M_TX_EMPTY_BITS);  // Escrita maior que a FIFO
+  VERIFICA(escrever(ADDR_A, 2, I2C_PRIORIDADE_BAIXA));
+  i2c_simulado_executar();
+
+  VERIFICA(i2c_sim.abortou);
+  VERIFICA(!(i2c_sim.mascara_apos_abort & I2C_IC_INTR_MASK_M_TX_EMPTY_BITS));
+  VERIFICA_IGUAL(n_concluidas, 2);
+  VERIFICA_IGUAL(concluidas[0], 1);
+  VERIFICA(!resultados[0]);
+  VERIFICA_IGUAL(concluidas[1], 2);
+  VERIFICA(resultados[1]);
+  VERIFICA_IGUAL(i2c_fila_erros(), 1);
+  VERIFICA(i2c_sim.interrupcoes < 10);
+}
+
+// Transação que não termina é apontada como barramento preso
+static void teste_travada(void) {
+  preparar();
+  VERIFICA(escrever(ADDR_A, 0, I2C_PRIORIDADE_ALTA));
+  sim_avancar_ms(100);
+  VERIFICA(!i2c_fila_travada(500000));
+  sim_avancar_ms(500);
+  VERIFICA(i2c_fila_travada(500000));
+  i2c_simulado_executar();
+  VERIFICA(!i2c_fila_travada(500000));
+}
+
+static void teste_transacao_vazia(void) {
+  preparar();
+  i2c_transacao_t t = { .endereco = ADDR_A };
+  VERIFICA(!i2c_fila_enviar(&t, I2C_PRIORIDADE_ALTA));
+  VERIFICA(i2c_fila_ociosa());
+}
+
+int main(void) {
+  TESTE(teste_prioridade);
+  TESTE(teste_anel);
+  TESTE(teste_escrita_longa);
+  TESTE(teste_leitura);
+  TESTE(teste_abort);
+  TESTE(teste_travada);
+  TESTE(teste_transacao_vazia);
+  return teste_resultado();
+}
@@ -0,0 +1,154 @@
+// AHT20 e SGP30 lidos pela fila I2C a partir de quadros prontos, com CRC válido e corrompido
+#include <string.h>
+#include "teste.h"
+#include "sdk_simulado.h"
+#include "i2c_simulado.h"
+#include "i2c_fila.h"
+#include "crc8.h"
+#include "aht20.h"
+#include "sgp30.h"
+
+// AHT20 simulado: inicializa com 0xBE, mede com 0xAC e responde status + 5 bytes + CRC
+#define AHT20_SIM_CONVERSAO_US 90000  // Um pouco mais que os 80 ms esperados pelo driver
+
+static struct {
+  bool calibrado;
+  uint64_t medicao_us;
+  uint32_t umidade_bruta, temperatura_bruta;
+  bool crc_errado;
+  uint32_t leituras_ocupado;
+} aht;
+
+static void aht_escrita(const uint8_t *dados, uint16_t len) {
+  if (len == 3 && dados[0] == 0xBE)
+    aht.calibrado = true;
+  if (len == 3 && dados[0] == 0xAC)
+    aht.medicao_us = time_us_64();
+}
+
+static uint8_t aht_leitura(uint16_t pos) {
+  bool ocupado = time_us_64() - aht.medicao_us < AHT20_SIM_CONVERSAO_US;
+  if (pos == 0 && ocupado)
+    aht.leituras_ocupado++;
+  uint8_t quadro[7] = {
+    (uint8_t)((ocupado ? 0x80 : 0x00) | (aht.calibrado ? 0x08 : 0x00)),
+    (uint8_t)(aht.umidade_bruta >> 12),
+    (uint8_t)(aht.umidade_bruta >> 4),
+    (uint8_t)(((aht.umidade_bruta & 0x0F) << 4) | (aht.temperatura_bruta >> 16)),
+    (uint8_t)(aht.temperatura_bruta >> 8),
+    (uint8_t)aht.temperatura_bruta,
+  };
+  quadro[6] = crc8_sensor(quadro, 6) ^ (aht.crc_errado ? 0x5A : 0x00);
+  return pos < 7 ? quadro[pos] : 0xFF;
+}
+
+static const i2c_dispositivo_t aht20_sim = { AHT20_ADDR, aht_escrita, aht_leitura };
+
+// SGP30 simulado: Init_air_quality (0x2003) e Measure_air_quality (0x2008)
+static struct {
+  bool iniciado;
+  uint16_t eco2, tvoc;
+  bool crc_errado;
+} sgp;
+
+static void sgp_escrita(const uint8_t *dados, uint16_t len) {
+  if (len == 2 && dados[0] == 0x20 && dados[1] == 0x03)
+    sgp.iniciado = true;
+}
+
+static uint8_t sgp_leitura(uint16_t pos) {
+  uint8_t quadro[6] = {
+    (uint8_t)(sgp.eco2 >> 8), (uint8_t)sgp.eco2, 0,
+    (uint8_t)(sgp.tvoc >> 8), (uint8_t)sgp.tvoc, 0,
+  };
+  quadro[2] = crc8_sensor(&quadro[0], 2);
+  quadro[5] = crc8_sensor(&quadro[3], 2) ^ (sgp.crc_errado ? 0x01 : 0x00);
+  return pos < 6 ? quadro[pos] : 0xFF;
+}
+
+static const i2c_dispositivo_t sgp30_sim = { SGP30_ADDR, sgp_escrita, sgp_leitura };
+
+// Exemplos das folhas de dados
+static void teste_crc8(void) {
+  const uint8_t beef[] = { 0xBE, 0xEF };
+  VERIFICA_IGUAL(crc8_sensor(beef, 2), 0x92);
+  const uint8_t zeros[] = { 0x00, 0x00 };
+  VERIFICA_IGUAL(crc8_sensor(zeros, 2), 0x81);
+}
+
+static void teste_sensores(void) {
+  sim_reiniciar();
+  i2c_simulado_reiniciar();
+  sim_apos_alarme = i2c_simulado_executar;  // O barramento anda junto com os timers
+  i2c_simulado_conectar(&aht20_sim);
+  i2c_simulado_conectar(&sgp30_sim);
+  i2c_fila_init(i2c1);
+
+  // 50 %UR e 30 °C em valores brutos de 20 bits
+  aht.umidade_bruta = 1u << 19;
+  aht.temperatura_bruta = 0x66666;
+  sgp.eco2 = 400;
+  sgp.tvoc = 250;
+
+  // Inicialização dos dois sensores enviada já, sem esperar os timers
+  aht20_iniciar(AHT20_PERIODO_MS);
+  sgp30_iniciar();
+  i2c_simulado_executar();  // Na placa, a interrupção I2C começa a transmitir de imediato
+  VERIFICA(aht.calibrado);
+  VERIFICA(sgp.iniciado);
+  VERIFICA(!aht20_presente());
+  VERIFICA(!sgp30_presente());
+  VERIFICA_IGUAL(aht20_primeira_leitura(), 0);
+
+  // Primeira medição logo após a inicialização: SGP30 em dezenas de ms, AHT20 após a
+  // conversão (o simulado leva um pouco mais que os 80 ms: a leitura ocupada é repetida)
+  sim_avancar_ms(200);
+  VERIFICA(sgp30_presente());
+  VERIFICA(sgp30_primeira_leitura() > 0 && sgp30_primeira_leitura() <= 50000);
+  VERIFICA(aht20_presente());
+  VERIFICA(aht20_primeira_leitura() > AHT20_SIM_CONVERSAO_US && aht20_primeira_leitura() <= 150000);
+  VERIFICA_IGUAL(aht20_temperatura(), 30);
+  VERIFICA_IGUAL(aht20_umidade(), 50);
+  VERIFICA(aht.leituras_ocupado > 0);  // Leitura com status ocupado foi repetida
+
+  // Medições seguintes pelos timers; o instante da primeira leitura não muda
+  uint64_t primeira = aht20_primeira_leitura();
+  sim_avancar_ms(2 * AHT20_PERIODO_MS);
+  VERIFICA_IGUAL(aht20_primeira_leitura(), primeira);
+  VERIFICA(sgp30_presente());
+  VERIFICA_IGUAL(sgp30_eco2(), 400);
+  VERIFICA_IGUAL(sgp30_tvoc(), 250);
+  VERIFICA_IGUAL(sgp30_qualidade_ar(), 75);
+
+  // Quadros com CRC errado são descartados: valores anteriores mantidos
+  aht.crc_errado = true;
+  aht.temperatura_bruta = 0x80000;  // 50 °C
+  sgp.crc_errado = true;
+  sgp.tvoc = 900;
+  sim_avancar_ms(2 * AHT20_PERIODO_MS);
+  VERIFICA_IGUAL(aht20_temperatura(), 30);
+  VERIFICA_IGUAL(sgp30_tvoc(), 250);
+
+  // CRC volta a bater: novos valores aceitos
+  aht.crc_errado = false;
+  sgp.crc_errado = false;
+  sim_avancar_ms(2 * AHT20_PERIODO_MS);
+  VERIFICA_IGUAL(aht20_temperatura(), 50);
+  VERIFICA_IGUAL(sgp30_tvoc(), 900);
+  VERIFICA_IGUAL(sgp30_qualidade_ar(), 10);
+  VERIFICA_IGUAL(i2c_fila_erros(), 0);
+  VERIFICA_IGUAL(i2c_sim.estouros_fifo, 0);
+
+  // Sensor desconectado: NACK marca o sensor como ausente
+  i2c_simulado_desconectar(AHT20_ADDR);
+  sim_avancar_ms(2 * AHT20_PERIODO_MS);
+  VERIFICA(!aht20_presente());
+  VERIFICA(i2c_fila_erros() > 0);
+  VERIFICA(sgp30_presente());
+}
+
+int main(void) {
+  TESTE(teste_crc8);
+  TESTE(teste_sensores);
+  return teste_resultado();
+}
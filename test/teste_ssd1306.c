@@ -0,0 +1,130 @@
+// Painéis SSD1306 de geometrias diferentes no mesmo programa: as funções geradas por
+// SSD1306_PAINEL e as ssd1306_* desenham o mesmo quadro, cada painel dentro do seu buffer
+#include <string.h>
+#include "teste.h"
+#include "sdk_simulado.h"
+#include "i2c_simulado.h"
+#include "i2c_fila.h"
+#include "ssd1306.h"
+
+SSD1306_PAINEL(grande, SSD1306_128X64_LARGURA, SSD1306_128X64_ALTURA)
+SSD1306_PAINEL(pequeno, SSD1306_128X32_LARGURA, SSD1306_128X32_ALTURA)
+SSD1306_PAINEL(estreito, SSD1306_64X48_LARGURA, SSD1306_64X48_ALTURA)
+
+static uint8_t generico[SSD1306_BUFSIZE(128, 64)];
+
+// Mesma cena pelas funções do painel e pelas genéricas
+#define CENA(prefixo, ssd)                              \
+  do {                                                  \
+    prefixo##_draw_string(ssd, "ALERTA 3 DE 12", 0, 0); \
+    prefixo##_rect(ssd, 10, 100, 20, 8, true, true);    \
+    prefixo##_rect(ssd, 20, 4, 30, 12, true, false);    \
+    prefixo##_line(ssd, 0, 63, 127, 0, true);           \
+    prefixo##_hline(ssd, 0, 127, 40, true);             \
+    prefixo##_vline(ssd, 60, 0, 47, true);              \
+    prefixo##_draw_char(ssd, 'Z', 120, 24);             \
+  } while (0)
+
+static void teste_mesma_cena(void) {
+  ssd1306_t ssd, ref;
+
+  grande_init(&ssd, false, 0x3C, NULL);
+  ssd1306_init(&ref, generico, 128, 64, false, 0x3C, NULL);
+  CENA(grande, &ssd);
+  CENA(ssd1306, &ref);
+  VERIFICA(memcmp(grande_buffer, generico, sizeof(grande_buffer)) == 0);
+
+  pequeno_init(&ssd, false, 0x3C, NULL);
+  ssd1306_init(&ref, generico, 128, 32, false, 0x3C, NULL);
+  CENA(pequeno, &ssd);
+  CENA(ssd1306, &ref);
+  VERIFICA(memcmp(pequeno_buffer, generico, sizeof(pequeno_buffer)) == 0);
+
+  estreito_init(&ssd, false, 0x3C, NULL);
+  ssd1306_init(&ref, generico, 64, 48, false, 0x3C, NULL);
+  CENA(estreito, &ssd);
+  CENA(ssd1306, &ref);
+  VERIFICA(memcmp(estreito_buffer, generico, sizeof(estreito_buffer)) == 0);
+}
+
+// O painel de 32 linhas é indexado com 4 páginas, mesmo ao lado de um de 64
+static void teste_geometria_por_painel(void) {
+  ssd1306_t a, b;
+  grande_init(&a, false, 0x3C, NULL);
+  pequeno_init(&b, false, 0x3D, NULL);
+  VERIFICA_IGUAL(sizeof(pequeno_buffer), 128 * 4 + 1);
+
+  ssd1306_pixel(&b, 1, 31, true);
+  VERIFICA_IGUAL(pequeno_buffer[SSD1306_INDEX(4, 1, 31)], 0x80);
+  VERIFICA_IGUAL(pequeno_buffer[1 * 4 + 3 + 1], 0x80);
+  pequeno_pixel(&b, 127, 31, true);
+  VERIFICA_IGUAL(pequeno_buffer[sizeof(pequeno_buffer) - 1], 0x80);
+
+  // Fora do painel pequeno: nada é escrito, nem no buffer do vizinho
+  ssd1306_pixel(&b, 127, 40, true);
+  pequeno_pixel(&b, 127, 40, true);
+  ssd1306_rect(&b, 28, 120, 20, 20, true, true);
+  for (size_t i = 0; i < sizeof(grande_buffer); i++)
+    VERIFICA_IGUAL(grande_buffer[i], i == 0 ? 0x40 : 0);
+}
+
+// Colunas de caracteres acesas em uma linha de texto (página y/8)
+static uint8_t colunas_acesas(const uint8_t *buffer, uint8_t largura, uint8_t altura, uint8_t y) {
+  uint8_t ultima = 0;
+  for (uint8_t x = 0; x < largura; x++) {
+    if (buffer[SSD1306_INDEX(SSD1306_PAGES(altura), x, y)])
+      ultima = x / 8 + 1;
+  }
+  return ultima;
+}
+
+// A última linha e a última coluna de caracteres cabem inteiras na tela
+static void teste_texto_ate_a_borda(void) {
+  ssd1306_t ssd;
+  grande_init(&ssd, false, 0x3C, NULL);
+  grande_draw_string(&ssd, "0123456789012345", 0, 56);
+  VERIFICA_IGUAL(colunas_acesas(grande_buffer, 128, 64, 56), 16);
+
+  pequeno_init(&ssd, false, 0x3C, NULL);
+  pequeno_draw_string(&ssd, "07 T45 Q20 M120", 0, 24);
+  VERIFICA_IGUAL(colunas_acesas(pequeno_buffer, 128, 32, 24), 15);
+
+  // Texto maior que a linha quebra para a seguinte; sem linha seguinte, para
+  estreito_init(&ssd, false, 0x3C, NULL);
+  estreito_draw_string(&ssd, "ABCDEFGHIJ", 0, 32);
+  VERIFICA_IGUAL(colunas_acesas(estreito_buffer, 64, 48, 32), 8);
+  VERIFICA_IGUAL(colunas_acesas(estreito_buffer, 64, 48, 40), 2);
+  estreito_init(&ssd, false, 0x3C, NULL);
+  estreito_draw_string(&ssd, "ABCDEFGHIJ", 0, 40);
+  VERIFICA_IGUAL(colunas_acesas(estreito_buffer, 64, 48, 40), 8);
+  VERIFICA_IGUAL(colunas_acesas(estreito_buffer, 64, 48, 32), 0);
+}
+
+// Fila cheia: comandos e quadros recusados são informados em vez de perdidos em silêncio
+static void teste_fila_cheia(void) {
+  sim_reiniciar();
+  i2c_simulado_reiniciar();
+  i2c_fila_init(i2c1);  // Barramento parado: nada sai da fila
+
+  ssd1306_t ssd;
+  grande_init(&ssd, false, 0x3C, i2c1);
+  ssd1306_usar_fila(&ssd);
+  VERIFICA(ssd1306_send_data(&ssd));
+  VERIFICA(!ssd1306_send_data(&ssd));  // Quadro anterior ainda em envio
+
+  uint32_t aceitos = 0;
+  while (ssd1306_command(&ssd, SET_DISP | 0x00))
+    aceitos++;
+  VERIFICA(aceitos > 0);
+  VERIFICA_IGUAL(i2c_fila_livres(I2C_PRIORIDADE_BAIXA), 0);
+  VERIFICA(!ssd1306_command(&ssd, SET_DISP | 0x01));
+  VERIFICA(!ssd1306_config(&ssd));
+}
+
+int main(void) {
+  TESTE(teste_mesma_cena);
+  TESTE(teste_geometria_por_painel);
+  TESTE(teste_texto_ate_a_borda);
+  TESTE(teste_fila_cheia);
+  return teste_resultado();
+}
@@ -0,0 +1,269 @@
+// Vigia em tempo virtual: estouro contado uma única vez (alarme e fim da etapa), nenhum
+// alarme fora das etapas, watchdog
+// sem alimentação quando falta check-in (com o motivo no scratch) e codificação dos
+// registradores de scratch
+#include "teste.h"
+#include "sdk_simulado.h"
+#include "hardware/watchdog.h"
+#include "vigia.h"
+
+#define ORCAMENTO_LACO_MS 1000
+
+// Mesma estrutura do laço do firmware, com menos etapas
+enum { ETAPA_AMOSTRAGEM, ETAPA_DISPLAY, ETAPA_I2C };
+#define ORCAMENTO_AMOSTRAGEM_MS 100
+#define ORCAMENTO_DISPLAY_MS 50
+
+static void preparar(bool reset_pelo_watchdog) {
+  sim_reiniciar();
+  sim_watchdog_reset = reset_pelo_watchdog;
+  vigia_init(ORCAMENTO_LACO_MS);
+}
+
+static void etapa(uint8_t etapa, uint32_t duracao_ms) {
+  vigia_etapa_inicio(etapa);
+  sim_avancar_ms(duracao_ms);
+  vigia_etapa_fim(etapa);
+}
+
+static void teste_codificacao(void) {
+  const uint8_t etapas[] = { 0, 1, VIGIA_MAX_ETAPAS - 1, VIGIA_SEM_ETAPA };
+  for (unsigned i = 0; i < sizeof(etapas); i++) {
+    uint8_t lida = 0;
+    VERIFICA(vigia_decodificar_etapa(vigia_codificar_etapa(etapas[i]), &lida));
+    VERIFICA_IGUAL(lida, etapas[i]);
+
+    const uint32_t duracoes[] = { 0, 1, 250, VIGIA_DURACAO_MAX };
+    for (unsigned j = 0; j < sizeof(duracoes) / sizeof(duracoes[0]); j++) {
+      uint32_t ultimo = vigia_codificar_estouro(etapas[i], duracoes[j]);
+      VERIFICA_IGUAL(vigia_estouro_etapa(ultimo), etapas[i]);
+      VERIFICA_IGUAL(vigia_estouro_duracao_ms(ultimo), duracoes[j]);
+      VERIFICA_IGUAL(vigia_sem_checkin(ultimo), 0);
+    }
+  }
+
+  // Duração acima do campo satura em vez de dar a volta
+  uint32_t ultimo = vigia_codificar_estouro(ETAPA_DISPLAY, VIGIA_DURACAO_MAX + 5);
+  VERIFICA_IGUAL(vigia_estouro_etapa(ultimo), ETAPA_DISPLAY);
+  VERIFICA_IGUAL(vigia_estouro_duracao_ms(ultimo), VIGIA_DURACAO_MAX);
+
+  // Falta de check-in usa o mesmo registrador sem parecer um estouro
+  const uint32_t faltando = (1u << ETAPA_I2C) | (1u << (VIGIA_MAX_ETAPAS - 1));
+  VERIFICA_IGUAL(vigia_sem_checkin(vigia_codificar_sem_checkin(faltando)), faltando);
+
+  // Sem a marca (energização ou outro firmware) não há etapa
+  uint8_t lida;
+  VERIFICA(!vigia_decodificar_etapa(0, &lida));
+  VERIFICA(!vigia_decodificar_etapa(0x12340001u, &lida));
+}
+
+// A etapa em andamento fica nos registradores e sobrevive ao reset pelo watchdog
+static void teste_scratch_no_reset(void) {
+  sim_watchdog.scratch[VIGIA_SCRATCH_ETAPA] = 0;
+  preparar(false);
+  VERIFICA_IGUAL(vigia_estouros(), 0);
+
+  sim_avancar_ms(3000);
+  vigia_etapa_inicio(ETAPA_DISPLAY);
+  uint8_t lida = 0;
+  VERIFICA(vigia_decodificar_etapa(sim_watchdog.scratch[VIGIA_SCRATCH_ETAPA], &lida));
+  VERIFICA_IGUAL(lida, ETAPA_DISPLAY);
+  VERIFICA_IGUAL(sim_watchdog.scratch[VIGIA_SCRATCH_INICIO], 3000);
+
+  // Travamento: o alarme do prazo registra o estouro antes do reset
+  sim_avancar_ms(VIGIA_TIMEOUT_MS);
+  VERIFICA_IGUAL(vigia_estouros(), 1);
+  uint32_t ultimo = sim_watchdog.scratch[VIGIA_SCRATCH_ULTIMO];
+  VERIFICA_IGUAL(vigia_estouro_etapa(ultimo), ETAPA_DISPLAY);
+  VERIFICA_IGUAL(vigia_estouro_duracao_ms(ultimo), ORCAMENTO_DISPLAY_MS + 1);
+
+  // Reset pelo watchdog mantém o contador; energização zera
+  preparar(true);
+  VERIFICA_IGUAL(vigia_estouros(), 1);
+  VERIFICA(vigia_decodificar_etapa(sim_watchdog.scratch[VIGIA_SCRATCH_ETAPA], &lida));
+  VERIFICA_IGUAL(lida, VIGIA_SEM_ETAPA);
+  preparar(false);
+  VERIFICA_IGUAL(vigia_estouros(), 0);
+}
+
+// Etapa que passa do orçamento com as interrupções mascaradas (ex.: gravação na flash): o
+// alarme vence sem disparar, o estouro é contado no fim da etapa e o alarme é cancelado
+static void teste_estouro_no_fim(void) {
+  preparar(false);
+  vigia_etapa_inicio(ETAPA_AMOSTRAGEM);
+  sim_avancar_mascarado_us((ORCAMENTO_AMOSTRAGEM_MS + 50) * 1000);
+  vigia_etapa_fim(ETAPA_AMOSTRAGEM);
+  VERIFICA_IGUAL(vigia_estouros(), 1);
+  uint32_t ultimo = sim_watchdog.scratch[VIGIA_SCRATCH_ULTIMO];
+  VERIFICA_IGUAL(vigia_estouro_etapa(ultimo), ETAPA_AMOSTRAGEM);
+  VERIFICA_IGUAL(vigia_estouro_duracao_ms(ultimo), ORCAMENTO_AMOSTRAGEM_MS + 50);
+  sim_avancar_ms(1000);
+  VERIFICA_IGUAL(vigia_estouros(), 1);
+
+  // Dentro do orçamento não conta
+  etapa(ETAPA_AMOSTRAGEM, ORCAMENTO_AMOSTRAGEM_MS);
+  VERIFICA_IGUAL(vigia_estouros(), 1);
+}
+
+// Etapa longa passa do prazo e termina bem depois: um único estouro
+static void teste_estouro_contado_uma_vez(void) {
+  preparar(false);
+  uint32_t secoes = sim_secoes_criticas;
+  etapa(ETAPA_DISPLAY, 20 * ORCAMENTO_DISPLAY_MS);
+  VERIFICA_IGUAL(vigia_estouros(), 1);
+
+  // Duração registrada é a da detecção pelo alarme, não a do fim
+  uint32_t ultimo = sim_watchdog.scratch[VIGIA_SCRATCH_ULTIMO];
+  VERIFICA_IGUAL(vigia_estouro_etapa(ultimo), ETAPA_DISPLAY);
+  VERIFICA_IGUAL(vigia_estouro_duracao_ms(ultimo), ORCAMENTO_DISPLAY_MS + 1);
+
+  // Início, registro pelo alarme e fim rodam com interrupções mascaradas
+  VERIFICA(sim_secoes_criticas - secoes >= 3);
+
+  // A etapa seguinte volta a ser vigiada, com o prazo contado do seu próprio início
+  etapa(ETAPA_AMOSTRAGEM, ORCAMENTO_AMOSTRAGEM_MS);
+  VERIFICA_IGUAL(vigia_estouros(), 1);
+  etapa(ETAPA_DISPLAY, 2 * ORCAMENTO_DISPLAY_MS);
+  VERIFICA_IGUAL(vigia_estouros(), 2);
+}
+
+static uint32_t alarmes_disparados;
+
+static void contar_alarme(void) {
+  alarmes_disparados++;
+}
+
+// Etapas em dia e o intervalo entre elas não disparam nenhum alarme: o vigia não tira o
+// núcleo do sono
+static void teste_sem_alarme_fora_das_etapas(void) {
+  preparar(false);
+  alarmes_disparados = 0;
+  sim_apos_alarme = contar_alarme;
+  for (int i = 0; i < 5; i++) {
+    vigia_laco_inicio();
+    etapa(ETAPA_AMOSTRAGEM, ORCAMENTO_AMOSTRAGEM_MS);
+    etapa(ETAPA_DISPLAY, ORCAMENTO_DISPLAY_MS);
+    vigia_checkin(ETAPA_I2C);
+    vigia_laco_fim();
+    sim_avancar_ms(VIGIA_TIMEOUT_MS);
+  }
+  VERIFICA_IGUAL(alarmes_disparados, 0);
+  VERIFICA_IGUAL(vigia_estouros(), 0);
+
+  // Só uma etapa presa dispara, uma única vez
+  vigia_etapa_inicio(ETAPA_DISPLAY);
+  sim_avancar_ms(VIGIA_TIMEOUT_MS);
+  VERIFICA_IGUAL(alarmes_disparados, 1);
+  vigia_etapa_fim(ETAPA_DISPLAY);
+  VERIFICA_IGUAL(vigia_estouros(), 1);
+}
+
+// Watchdog só é alimentado quando todas as etapas registradas fizeram check-in
+static void teste_checkin(void) {
+  preparar(false);
+  VERIFICA_IGUAL(sim_watchdog_timeout_ms, VIGIA_TIMEOUT_MS);
+
+  vigia_laco_inicio();
+  etapa(ETAPA_AMOSTRAGEM, 10);
+  etapa(ETAPA_DISPLAY, 10);
+  vigia_checkin(ETAPA_I2C);
+  vigia_laco_fim();
+  VERIFICA_IGUAL(sim_watchdog_alimentacoes, 1);
+
+  // Fila I2C presa: sem check-in de ETAPA_I2C o watchdog não é alimentado e o scratch
+  // guarda quem faltou
+  vigia_laco_inicio();
+  etapa(ETAPA_AMOSTRAGEM, 10);
+  etapa(ETAPA_DISPLAY, 10);
+  vigia_laco_fim();
+  VERIFICA_IGUAL(sim_watchdog_alimentacoes, 1);
+  VERIFICA_IGUAL(vigia_sem_checkin(sim_watchdog.scratch[VIGIA_SCRATCH_ULTIMO]), 1u << ETAPA_I2C);
+
+  // Check-ins da iteração anterior não valem para a seguinte
+  vigia_laco_inicio();
+  vigia_checkin(ETAPA_I2C);
+  vigia_laco_fim();
+  VERIFICA_IGUAL(sim_watchdog_alimentacoes, 1);
+  VERIFICA_IGUAL(vigia_sem_checkin(sim_watchdog.scratch[VIGIA_SCRATCH_ULTIMO]),
+                 (1u << ETAPA_AMOSTRAGEM) | (1u << ETAPA_DISPLAY));
+
+  vigia_laco_inicio();
+  etapa(ETAPA_DISPLAY, 10);
+  etapa(ETAPA_AMOSTRAGEM, 10);
+  vigia_checkin(ETAPA_I2C);
+  vigia_laco_fim();
+  VERIFICA_IGUAL(sim_watchdog_alimentacoes, 2);
+  VERIFICA_IGUAL(vigia_estouros(), 0);
+  VERIFICA_IGUAL(sim_watchdog.scratch[VIGIA_SCRATCH_ULTIMO], 0);
+}
+
+// Falta de check-in recuperada devolve o registro do último estouro; a que leva ao reset
+// é relatada na inicialização seguinte e não se confunde com um estouro
+static void teste_checkin_no_reset(void) {
+  preparar(false);
+  vigia_laco_inicio();
+  etapa(ETAPA_DISPLAY, ORCAMENTO_DISPLAY_MS + 5);
+  etapa(ETAPA_AMOSTRAGEM, 10);
+  vigia_laco_fim();
+  VERIFICA_IGUAL(sim_watchdog.scratch[VIGIA_SCRATCH_ULTIMO], vigia_codificar_sem_checkin(1u << ETAPA_I2C));
+
+  // Estouro enquanto falta check-in é contado, mas não apaga o motivo do reset iminente
+  vigia_laco_inicio();
+  etapa(ETAPA_AMOSTRAGEM, ORCAMENTO_AMOSTRAGEM_MS + 7);
+  VERIFICA_IGUAL(vigia_estouros(), 2);
+  VERIFICA_IGUAL(sim_watchdog.scratch[VIGIA_SCRATCH_ULTIMO], vigia_codificar_sem_checkin(1u << ETAPA_I2C));
+  vigia_laco_fim();
+  VERIFICA_IGUAL(vigia_sem_checkin(sim_watchdog.scratch[VIGIA_SCRATCH_ULTIMO]),
+                 (1u << ETAPA_DISPLAY) | (1u << ETAPA_I2C));
+
+  vigia_laco_inicio();
+  etapa(ETAPA_DISPLAY, 10);
+  etapa(ETAPA_AMOSTRAGEM, 10);
+  vigia_checkin(ETAPA_I2C);
+  vigia_laco_fim();
+  uint32_t estouro = vigia_codificar_estouro(ETAPA_AMOSTRAGEM, ORCAMENTO_AMOSTRAGEM_MS + 1);
+  VERIFICA_IGUAL(sim_watchdog.scratch[VIGIA_SCRATCH_ULTIMO], estouro);
+  VERIFICA_IGUAL(vigia_sem_checkin(estouro), 0);
+
+  // Sem check-in até o reset: o registro sobrevive ao reset, é lido e depois limpo
+  vigia_laco_inicio();
+  etapa(ETAPA_AMOSTRAGEM, 10);
+  etapa(ETAPA_DISPLAY, 10);
+  vigia_laco_fim();
+  VERIFICA_IGUAL(vigia_sem_checkin(sim_watchdog.scratch[VIGIA_SCRATCH_ULTIMO]), 1u << ETAPA_I2C);
+  preparar(true);
+  VERIFICA_IGUAL(vigia_estouros(), 2);
+  VERIFICA_IGUAL(sim_watchdog.scratch[VIGIA_SCRATCH_ULTIMO], 0);
+}
+
+// Laço acima do orçamento com etapas em dia: estouro atribuído ao laço
+static void teste_estouro_do_laco(void) {
+  preparar(false);
+  vigia_laco_inicio();
+  etapa(ETAPA_AMOSTRAGEM, 10);
+  etapa(ETAPA_DISPLAY, 10);
+  vigia_checkin(ETAPA_I2C);
+  sim_avancar_ms(ORCAMENTO_LACO_MS);
+  vigia_laco_fim();
+  VERIFICA_IGUAL(vigia_estouros(), 1);
+  uint32_t ultimo = sim_watchdog.scratch[VIGIA_SCRATCH_ULTIMO];
+  VERIFICA_IGUAL(vigia_estouro_etapa(ultimo), VIGIA_SEM_ETAPA);
+  VERIFICA_IGUAL(vigia_estouro_duracao_ms(ultimo), ORCAMENTO_LACO_MS + 20);
+  VERIFICA_IGUAL(sim_watchdog_alimentacoes, 1);  // Lento, mas não travado
+}
+
+int main(void) {
+  vigia_registrar(ETAPA_AMOSTRAGEM, "amostragem", ORCAMENTO_AMOSTRAGEM_MS);
+  vigia_registrar(ETAPA_DISPLAY, "display", ORCAMENTO_DISPLAY_MS);
+  vigia_registrar(ETAPA_I2C, "i2c", 0);
+
+  TESTE(teste_codificacao);
+  TESTE(teste_scratch_no_reset);
+  TESTE(teste_estouro_no_fim);
+  TESTE(teste_estouro_contado_uma_vez);
+  TESTE(teste_sem_alarme_fora_das_etapas);
+  TESTE(teste_checkin);
+  TESTE(teste_checkin_no_reset);
+  TESTE(teste_estouro_do_laco);
+  return teste_resultado();
+}